@@ -10,7 +10,7 @@
 #include <regex>
 
 void benchmark::ConsolePrinter::header() {
-  std::cout << "# Benchmark, evals, iterations, total, min, max, median"
+  std::cout << "# Benchmark, evals, iterations, total, min, max, median[, rate]"
             << std::endl;
 }
 
@@ -39,7 +39,11 @@ void benchmark::ConsolePrinter::result(const State &state) {
   std::cout << std::setprecision(6);
   std::cout << state.m_name << ", " << state.m_num_evals << ", "
             << state.m_num_iters << ", " << total << ", " << front << ", "
-            << back << ", " << median << std::endl;
+            << back << ", " << median;
+  if (state.m_items_per_iter && median > 0)
+    std::cout << ", " << state.m_items_per_iter / median << " "
+              << state.m_items_unit << "/s";
+  std::cout << std::endl;
 }
 
 void benchmark::ConsolePrinter::footer() {}
@@ -36,9 +36,16 @@ public:
   const uint64_t m_num_evals;
   std::vector<double> m_elapsed_results;
   time_point m_start_time;
+  uint64_t m_items_per_iter = 0;
+  std::string m_items_unit;
 
   bool UpdateTimer(time_point finish_time);
 
+  void SetItemsPerIteration(uint64_t items, const std::string &unit) {
+    m_items_per_iter = items;
+    m_items_unit = unit;
+  }
+
   State(std::string name, uint64_t num_evals, double num_iters,
         Printer &printer)
       : m_name(name), m_num_iters_left(0), m_num_iters(num_iters),
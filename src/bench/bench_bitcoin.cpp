@@ -4,6 +4,7 @@
 
 #include <bench/bench.h>
 
+#include <crypto/scrypt.h>
 #include <crypto/sha256.h>
 #include <key.h>
 #include <random.h>
@@ -66,6 +67,7 @@ int main(int argc, char **argv) {
   }
 
   SHA256AutoDetect();
+  scrypt_detect_multiway();
   RandomInit();
   ECC_Start();
   SetupEnvironment();
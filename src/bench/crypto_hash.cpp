@@ -3,7 +3,9 @@
 
 #include <bench/bench.h>
 #include <bloom.h>
+#include <crypto/minotaurx/minotaur.h>
 #include <crypto/ripemd160.h>
+#include <crypto/scrypt.h>
 #include <crypto/sha1.h>
 #include <crypto/sha256.h>
 #include <crypto/sha512.h>
@@ -42,6 +44,47 @@ static void SHA256_32b(benchmark::State &state) {
   }
 }
 
+static void SHA256D64_1024(benchmark::State &state) {
+  std::vector<uint8_t> in(64 * 1024, 0);
+  while (state.KeepRunning()) {
+    SHA256D64(in.data(), in.data(), 1024);
+  }
+}
+
+static void MinotaurHash_80b(benchmark::State &state) {
+  MinotaurHasher hasher;
+  std::vector<uint8_t> in(80, 0);
+  while (state.KeepRunning()) {
+    uint256 hash = hasher.Hash(in.data(), in.size());
+    memcpy(in.data(), hash.begin(), hash.size());
+  }
+}
+
+static void MinotaurXHash_80b(benchmark::State &state) {
+  MinotaurHasher hasher;
+  std::vector<uint8_t> in(80, 0);
+  while (state.KeepRunning()) {
+    uint256 hash = hasher.Hash(in.data(), in.size(), true);
+    memcpy(in.data(), hash.begin(), hash.size());
+  }
+}
+
+static void Scrypt_80b(benchmark::State &state) {
+  std::vector<char> in(80, 0), out(32);
+  while (state.KeepRunning()) {
+    scrypt_1024_1_1_256(in.data(), out.data());
+    memcpy(in.data(), out.data(), out.size());
+  }
+}
+
+static void ScryptBatch_8x80b(benchmark::State &state) {
+  std::vector<char> in(80 * 8, 0), out(32 * 8);
+  while (state.KeepRunning()) {
+    scrypt_1024_1_1_256_multi(in.data(), out.data(), 8);
+    memcpy(in.data(), out.data(), out.size());
+  }
+}
+
 static void SHA512(benchmark::State &state) {
   uint8_t hash[CSHA512::OUTPUT_SIZE];
   std::vector<uint8_t> in(BUFFER_SIZE, 0);
@@ -79,6 +122,11 @@ BENCHMARK(SHA256, 340);
 BENCHMARK(SHA512, 330);
 
 BENCHMARK(SHA256_32b, 4700 * 1000);
+BENCHMARK(SHA256D64_1024, 7400);
+BENCHMARK(MinotaurHash_80b, 40 * 1000);
+BENCHMARK(MinotaurXHash_80b, 500);
+BENCHMARK(Scrypt_80b, 400);
+BENCHMARK(ScryptBatch_8x80b, 50);
 BENCHMARK(SipHash_32b, 40 * 1000 * 1000);
 BENCHMARK(FastRandom_32bit, 110 * 1000 * 1000);
 BENCHMARK(FastRandom_1bit, 440 * 1000 * 1000);
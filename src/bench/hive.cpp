@@ -0,0 +1,342 @@
+// Copyright (c) 2019-2021 The Litecoin Cash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+
+#include <arith_uint256.h>
+#include <base58.h>
+#include <chain.h>
+#include <chainparams.h>
+#include <coins.h>
+#include <crypto/common.h>
+#include <crypto/minotaurx/minotaur.h>
+#include <hash.h>
+#include <key.h>
+#include <miner.h>
+#include <pow.h>
+#include <primitives/block.h>
+#include <pubkey.h>
+#include <random.h>
+#include <script/standard.h>
+#include <test/mixed_chain.h>
+#include <uint256.h>
+#include <utiltime.h>
+#include <validation.h>
+
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Each iteration checks a single bee, so the reported time per iteration is
+// the inverse of the bees/second throughput of one hive check thread.
+
+static const std::string BENCH_DET_RAND_STRING =
+    uint256S("0x3a1b").GetHex() + uint256S("0x7c2d").GetHex() +
+    uint256S("0x51ee").GetHex() + uint256S("0x09f4").GetHex() +
+    uint256S("0xd26a").GetHex() + uint256S("0x8b13").GetHex();
+static const std::string BENCH_BCT_TXID = uint256S("0xbee").GetHex();
+
+static void BeeHashSHA256d(benchmark::State &state) {
+  CBeeHasher beeHasher(BENCH_DET_RAND_STRING, BENCH_BCT_TXID, false);
+  arith_uint256 beeHashTarget = 0;
+  uint32_t beeNonce = 0;
+  while (state.KeepRunning()) {
+    if (beeHasher.GetHash(beeNonce++) < beeHashTarget)
+      break;
+  }
+}
+
+static void BeeHashSHA256dBatch(benchmark::State &state) {
+  CBeeHasher beeHasher(BENCH_DET_RAND_STRING, BENCH_BCT_TXID, false);
+  arith_uint256 hashes[BEE_HASH_BATCH];
+  uint32_t beeNonce = 0;
+  while (state.KeepRunning()) {
+    beeHasher.GetHashes(beeNonce, BEE_HASH_BATCH, hashes);
+    beeNonce += BEE_HASH_BATCH;
+  }
+}
+
+static void BeeHashMinotaur(benchmark::State &state) {
+  MinotaurHasher minotaurHasher;
+  CBeeHasher beeHasher(BENCH_DET_RAND_STRING, BENCH_BCT_TXID, true,
+                       &minotaurHasher);
+  arith_uint256 beeHashTarget = 0;
+  uint32_t beeNonce = 0;
+  while (state.KeepRunning()) {
+    if (beeHasher.GetHash(beeNonce++) < beeHashTarget)
+      break;
+  }
+}
+
+// Check rounds hash a whole synthetic bee population, chunked the way
+// BusyBees queues it for the hive worker pool, against a target no bee can
+// meet. BCT sizes are either uniform or Zipf distributed.
+
+struct CBenchBeeRange {
+  std::string txid;
+  int offset;
+  int count;
+};
+
+static std::vector<CBenchBeeRange> MakeBeeChunks(int nBCTs, int nBees,
+                                                 bool zipf, int chunkSize) {
+  std::vector<double> weights(nBCTs);
+  double totalWeight = 0;
+  for (int i = 0; i < nBCTs; i++) {
+    weights[i] = zipf ? 1.0 / (i + 1) : 1.0;
+    totalWeight += weights[i];
+  }
+
+  std::vector<CBenchBeeRange> chunks;
+  int assigned = 0;
+  for (int i = 0; i < nBCTs; i++) {
+    const int beeCount = i == nBCTs - 1
+                             ? nBees - assigned
+                             : (int)(nBees * weights[i] / totalWeight);
+    assigned += beeCount;
+    const std::string txid =
+        (CHashWriter(SER_GETHASH, 0) << i).GetHash().GetHex();
+    for (int offset = 0; offset < beeCount; offset += chunkSize)
+      chunks.push_back({txid, offset, std::min(chunkSize, beeCount - offset)});
+  }
+  return chunks;
+}
+
+static void HiveCheckRound(benchmark::State &state, int nBCTs, int nBees,
+                           bool zipf, bool minotaurX) {
+  const std::vector<CBenchBeeRange> chunks =
+      MakeBeeChunks(nBCTs, nBees, zipf,
+                    minotaurX ? HIVE_CHUNK_SIZE_MINOTAUR
+                              : HIVE_CHUNK_SIZE_SHA256);
+  const arith_uint256 beeHashTarget = 0;
+  arith_uint256 hashes[BEE_HASH_BATCH];
+  state.SetItemsPerIteration(nBees, "bees");
+  while (state.KeepRunning()) {
+    for (const CBenchBeeRange &range : chunks) {
+      CBeeHasher beeHasher(BENCH_DET_RAND_STRING, range.txid, minotaurX);
+      const int end = range.offset + range.count;
+      for (int bee = range.offset; bee < end; bee += BEE_HASH_BATCH) {
+        const int n = std::min(BEE_HASH_BATCH, end - bee);
+        beeHasher.GetHashes(bee, n, hashes);
+        for (int j = 0; j < n; j++)
+          if (hashes[j] < beeHashTarget)
+            break;
+      }
+    }
+  }
+}
+
+static void HiveCheckSHA256d_100kBees_100BCTs(benchmark::State &state) {
+  HiveCheckRound(state, 100, 100 * 1000, false, false);
+}
+
+static void HiveCheckSHA256d_100kBees_10kBCTs(benchmark::State &state) {
+  HiveCheckRound(state, 10 * 1000, 100 * 1000, false, false);
+}
+
+static void HiveCheckSHA256d_100kBees_Zipf1kBCTs(benchmark::State &state) {
+  HiveCheckRound(state, 1000, 100 * 1000, true, false);
+}
+
+static void HiveCheckMinotaurX_2kBees_20BCTs(benchmark::State &state) {
+  HiveCheckRound(state, 20, 2000, false, true);
+}
+
+static void HiveCheckMinotaurX_2kBees_Zipf200BCTs(benchmark::State &state) {
+  HiveCheckRound(state, 200, 2000, true, true);
+}
+
+// Proof checks run CheckHiveProof on a hive block claiming an unspent BCT,
+// on a synthetic regtest chain with a full hive difficulty window, as a
+// node does for each hive block it receives. Hive blocks carry the easiest
+// target, so a winning bee turns up within the BCT's first few nonces.
+
+static void HiveProofCheck(benchmark::State &state, bool minotaurX) {
+  SelectParams(CBaseChainParams::REGTEST);
+  Consensus::Params params = HiveChainParams();
+  if (!minotaurX)
+    params.vDeployments[Consensus::DEPLOYMENT_MINOTAURX].nStartTime =
+        std::numeric_limits<int64_t>::max();
+  ECCVerifyHandle verifyHandle;
+  ResetDifficultyCache();
+
+  const int bctHeight = 10;
+  FastRandomContext rng(true);
+  std::vector<CBlockIndex> blocks(bctHeight + params.beeGestationBlocks + 40);
+  std::vector<uint256> hashes(blocks.size());
+  for (size_t i = 0; i < blocks.size(); i++) {
+    hashes[i] = rng.rand256();
+    blocks[i].phashBlock = &hashes[i];
+    do
+      MakeMixedBlockIndex(blocks[i], i ? &blocks[i - 1] : nullptr,
+                          1600000000 + i * params.nPowTargetSpacing, rng,
+                          params);
+    while (i + 1 == blocks.size() && blocks[i].IsHiveMined(params));
+    if (blocks[i].IsHiveMined(params))
+      blocks[i].nBits = UintToArith256(params.powLimitHive).GetCompact();
+  }
+  CBlockIndex *pindexPrev = &blocks.back();
+
+  CKey honeyKey;
+  honeyKey.MakeNewKey(true);
+  const CScript scriptPubKeyHoney =
+      GetScriptForDestination(honeyKey.GetPubKey().GetID());
+
+  CMutableTransaction bct;
+  bct.vin.resize(1);
+  bct.vin[0].prevout = COutPoint(rng.rand256(), 0);
+  bct.vout.resize(1);
+  bct.vout[0].scriptPubKey = GetScriptForDestination(
+      DecodeDestination(params.beeCreationAddress));
+  bct.vout[0].scriptPubKey << OP_RETURN << OP_BEE;
+  bct.vout[0].scriptPubKey += scriptPubKeyHoney;
+  bct.vout[0].nValue = GetBeeCost(bctHeight, params) * 1000;
+  const std::string bctTxid = bct.GetHash().GetHex();
+
+  const std::string detRandString = GetDeterministicRandString(pindexPrev);
+  arith_uint256 beeHashTarget;
+  beeHashTarget.SetCompact(GetNextHiveWorkRequired(pindexPrev, params));
+  CBeeHasher beeHasher(detRandString, bctTxid, minotaurX);
+  uint32_t beeNonce = 0;
+  while (beeHasher.GetHash(beeNonce) >= beeHashTarget)
+    beeNonce++;
+  assert(beeNonce < 1000);
+
+  unsigned char beeNonceEncoded[4], bctHeightEncoded[4];
+  WriteLE32(beeNonceEncoded, beeNonce);
+  WriteLE32(bctHeightEncoded, bctHeight);
+  std::vector<unsigned char> messageSig;
+  honeyKey.SignCompact(
+      (CHashWriter(SER_GETHASH, 0) << detRandString).GetHash(), messageSig);
+
+  CMutableTransaction coinbase;
+  coinbase.vin.resize(1);
+  coinbase.vin[0].prevout.SetNull();
+  coinbase.vout.resize(2);
+  coinbase.vout[0].scriptPubKey
+      << OP_RETURN << OP_BEE
+      << std::vector<unsigned char>(beeNonceEncoded, beeNonceEncoded + 4)
+      << std::vector<unsigned char>(bctHeightEncoded, bctHeightEncoded + 4)
+      << OP_FALSE << std::vector<unsigned char>(bctTxid.begin(), bctTxid.end())
+      << messageSig;
+  coinbase.vout[1].scriptPubKey = scriptPubKeyHoney;
+  CBlock block;
+  block.hashPrevBlock = pindexPrev->GetBlockHash();
+  block.vtx.push_back(MakeTransactionRef(std::move(coinbase)));
+
+  CCoinsView coinsDummy;
+  std::unique_ptr<CCoinsViewCache> pcoinsOld = std::move(pcoinsTip);
+  pcoinsTip.reset(new CCoinsViewCache(&coinsDummy));
+  pcoinsTip->AddCoin(COutPoint(bct.GetHash(), 0),
+                     Coin(bct.vout[0], bctHeight, false), false);
+  CBlockIndex *pindexOldTip;
+  {
+    LOCK(cs_main);
+    pindexOldTip = chainActive.Tip();
+    chainActive.SetTip(pindexPrev);
+    mapBlockIndex[block.hashPrevBlock] = pindexPrev;
+  }
+
+  assert(CheckHiveProof(&block, params));
+  state.SetItemsPerIteration(1, "proofs");
+  while (state.KeepRunning())
+    CheckHiveProof(&block, params);
+
+  {
+    LOCK(cs_main);
+    mapBlockIndex.erase(block.hashPrevBlock);
+    chainActive.SetTip(pindexOldTip);
+    versionbitscache.Clear();
+  }
+  pcoinsTip = std::move(pcoinsOld);
+  ResetDifficultyCache();
+}
+
+static void HiveProofSHA256d(benchmark::State &state) {
+  HiveProofCheck(state, false);
+}
+
+static void HiveProofMinotaurX(benchmark::State &state) {
+  HiveProofCheck(state, true);
+}
+
+// Network info benches walk one full bee lifespan of a synthetic mainnet
+// chain with a BCT every tenth block, with the bee population index already
+// warm as it is on a running node.
+
+static void HiveNetworkInfoWalk(benchmark::State &state, bool recalcGraph) {
+  SelectParams(CBaseChainParams::MAIN);
+  Consensus::Params params = Params().GetConsensus();
+  params.vDeployments[Consensus::DEPLOYMENT_HIVE_1_1].nStartTime =
+      Consensus::BIP9Deployment::ALWAYS_ACTIVE;
+  params.vDeployments[Consensus::DEPLOYMENT_MINOTAURX].nStartTime =
+      Consensus::BIP9Deployment::ALWAYS_ACTIVE;
+
+  CScript scriptPubKeyBCT = GetScriptForDestination(
+      DecodeDestination(params.beeCreationAddress));
+  scriptPubKeyBCT << OP_RETURN << OP_BEE;
+  scriptPubKeyBCT += GetScriptForDestination(CKeyID(uint160()));
+
+  const int totalBeeLifespan =
+      params.beeLifespanBlocks + params.beeGestationBlocks;
+  std::vector<CBlockIndex> blocks(totalBeeLifespan + 1);
+  const int64_t nTipTime = GetTime();
+  for (size_t i = 0; i < blocks.size(); i++) {
+    CBlockIndex &pindex = blocks[i];
+    pindex.pprev = i ? &blocks[i - 1] : nullptr;
+    pindex.nHeight = i;
+    pindex.nTime =
+        nTipTime - (blocks.size() - 1 - i) * params.nPowTargetSpacing;
+    pindex.BuildSkip();
+
+    CBlock block;
+    if (i % 10 == 0) {
+      CMutableTransaction bct;
+      bct.vin.resize(1);
+      bct.vout.resize(1);
+      bct.vout[0].scriptPubKey = scriptPubKeyBCT;
+      bct.vout[0].nValue = GetBeeCost(i, params) * (1 + (i / 10) % 100);
+      block.vtx.push_back(MakeTransactionRef(std::move(bct)));
+    }
+    AddBlockToBeePopIndex(block, &pindex, params);
+  }
+
+  {
+    LOCK(cs_main);
+    CBlockIndex *pindexOldTip = chainActive.Tip();
+    chainActive.SetTip(&blocks.back());
+
+    int immatureBees, immatureBCTs, matureBees, matureBCTs;
+    CAmount potentialLifespanRewards;
+    while (state.KeepRunning())
+      GetNetworkHiveInfo(immatureBees, immatureBCTs, matureBees, matureBCTs,
+                         potentialLifespanRewards, params, recalcGraph);
+
+    chainActive.SetTip(pindexOldTip);
+  }
+  for (const CBlockIndex &pindex : blocks)
+    RemoveBlockFromBeePopIndex(&pindex);
+}
+
+static void HiveNetworkInfo(benchmark::State &state) {
+  HiveNetworkInfoWalk(state, false);
+}
+
+static void HiveNetworkInfoGraph(benchmark::State &state) {
+  HiveNetworkInfoWalk(state, true);
+}
+
+BENCHMARK(BeeHashSHA256d, 1500 * 1000);
+BENCHMARK(BeeHashSHA256dBatch, 200 * 1000);
+BENCHMARK(BeeHashMinotaur, 20 * 1000);
+BENCHMARK(HiveCheckSHA256d_100kBees_100BCTs, 40);
+BENCHMARK(HiveCheckSHA256d_100kBees_10kBCTs, 20);
+BENCHMARK(HiveCheckSHA256d_100kBees_Zipf1kBCTs, 40);
+BENCHMARK(HiveCheckMinotaurX_2kBees_20BCTs, 30);
+BENCHMARK(HiveCheckMinotaurX_2kBees_Zipf200BCTs, 20);
+BENCHMARK(HiveProofSHA256d, 8000);
+BENCHMARK(HiveProofMinotaurX, 8000);
+BENCHMARK(HiveNetworkInfo, 600);
+BENCHMARK(HiveNetworkInfoGraph, 500);
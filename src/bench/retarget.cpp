@@ -0,0 +1,101 @@
+// Copyright (c) 2019-2021 The Litecoin Cash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+
+#include <chain.h>
+#include <chainparams.h>
+#include <pow.h>
+#include <primitives/block.h>
+#include <random.h>
+#include <test/mixed_chain.h>
+
+#include <vector>
+
+// Retarget benches run on a synthetic chain mixing both PoW types with hive
+// blocks. Each iteration retargets on the next block of the chain, as
+// templates do while following a growing chain; the Cold variants drop the
+// cached difficulty windows first and pay for a full window scan.
+
+static const int RETARGET_CHAIN_LENGTH = 4000;
+static const int RETARGET_FIRST_TIP = 1000;
+
+static void MakeRetargetChain(std::vector<CBlockIndex> &blocks,
+                              const Consensus::Params &params) {
+  FastRandomContext rng(true);
+  blocks.resize(RETARGET_CHAIN_LENGTH);
+  for (size_t i = 0; i < blocks.size(); i++)
+    MakeMixedBlockIndex(blocks[i], i ? &blocks[i - 1] : nullptr,
+                        1600000000 + i * params.nPowTargetSpacing / 2 +
+                            rng.randrange(params.nPowTargetSpacing),
+                        rng, params);
+}
+
+static void RetargetLWMAWalk(benchmark::State &state, bool cold) {
+  const Consensus::Params params = MixedChainParams();
+  std::vector<CBlockIndex> blocks;
+  MakeRetargetChain(blocks, params);
+  CBlockHeader header;
+  int tip = RETARGET_FIRST_TIP;
+  ResetDifficultyCache();
+  while (state.KeepRunning()) {
+    if (cold)
+      ResetDifficultyCache();
+    GetNextWorkRequiredLWMA(&blocks[tip], &header, params, POW_TYPE_SHA256);
+    if (++tip == RETARGET_CHAIN_LENGTH)
+      tip = RETARGET_FIRST_TIP;
+  }
+  ResetDifficultyCache();
+}
+
+static void RetargetHiveWalk(benchmark::State &state, bool cold) {
+  const Consensus::Params params = MixedChainParams();
+  std::vector<CBlockIndex> blocks;
+  MakeRetargetChain(blocks, params);
+  int tip = RETARGET_FIRST_TIP;
+  ResetDifficultyCache();
+  while (state.KeepRunning()) {
+    if (cold)
+      ResetDifficultyCache();
+    GetNextHiveWorkRequired(&blocks[tip], params);
+    if (++tip == RETARGET_CHAIN_LENGTH)
+      tip = RETARGET_FIRST_TIP;
+  }
+  ResetDifficultyCache();
+}
+
+static void RetargetLWMA(benchmark::State &state) {
+  RetargetLWMAWalk(state, false);
+}
+
+static void RetargetLWMACold(benchmark::State &state) {
+  RetargetLWMAWalk(state, true);
+}
+
+static void RetargetHive(benchmark::State &state) {
+  RetargetHiveWalk(state, false);
+}
+
+static void RetargetHiveCold(benchmark::State &state) {
+  RetargetHiveWalk(state, true);
+}
+
+static void RetargetDGW(benchmark::State &state) {
+  const Consensus::Params params = MixedChainParams();
+  std::vector<CBlockIndex> blocks;
+  MakeRetargetChain(blocks, params);
+  CBlockHeader header;
+  int tip = RETARGET_FIRST_TIP;
+  while (state.KeepRunning()) {
+    DarkGravityWave(&blocks[tip], &header, params);
+    if (++tip == RETARGET_CHAIN_LENGTH)
+      tip = RETARGET_FIRST_TIP;
+  }
+}
+
+BENCHMARK(RetargetLWMA, 150 * 1000);
+BENCHMARK(RetargetLWMACold, 800);
+BENCHMARK(RetargetHive, 70 * 1000);
+BENCHMARK(RetargetHiveCold, 70 * 1000);
+BENCHMARK(RetargetDGW, 5000);
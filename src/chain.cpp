@@ -133,6 +133,38 @@ void CBlockIndex::BuildSkip() {
     pskip = pprev->GetAncestor(GetSkipHeight(nHeight));
 }
 
+static int GetBlockKind(const CBlockIndex *pindex,
+                        const Consensus::Params &consensusParams) {
+  if (pindex->IsHiveMined(consensusParams))
+    return NUM_BLOCK_TYPES + 1;
+  if (pindex->nVersion & 0xFF000000)
+    return NUM_BLOCK_TYPES;
+  return pindex->GetPoWType();
+}
+
+void CBlockIndex::BuildPrevSameKind(const Consensus::Params &consensusParams) {
+  const int kindHive = NUM_BLOCK_TYPES + 1;
+  const int kindLegacy = NUM_BLOCK_TYPES;
+  const int kind = GetBlockKind(this, consensusParams);
+
+  pprevSameKind = nullptr;
+  for (CBlockIndex *pindex = pprev; pindex; pindex = pindex->pprev) {
+    const int prevKind = GetBlockKind(pindex, consensusParams);
+    if (prevKind == kind) {
+      pprevSameKind = pindex;
+      return;
+    }
+
+    if (kind == kindHive) {
+      if (pindex->nHeight < consensusParams.minHiveCheckBlock)
+        return;
+    } else if (prevKind != kindHive &&
+               (kind == kindLegacy || prevKind == kindLegacy)) {
+      return;
+    }
+  }
+}
+
 arith_uint256 GetBlockProof(const CBlockIndex &block) {
   const Consensus::Params &consensusParams = Params().GetConsensus();
   bool verbose = false;
@@ -147,11 +179,11 @@ arith_uint256 GetBlockProof(const CBlockIndex &block) {
 
   arith_uint256 bnTargetScaled = (~bnTarget / (bnTarget + 1)) + 1;
 
-  if (block.GetBlockHeader().IsHiveMined(consensusParams)) {
+  if (block.IsHiveMined(consensusParams)) {
     assert(block.pprev);
 
     CBlockIndex *pindexTemp = block.pprev;
-    while (pindexTemp->GetBlockHeader().IsHiveMined(consensusParams)) {
+    while (pindexTemp->IsHiveMined(consensusParams)) {
       assert(pindexTemp->pprev);
       pindexTemp = pindexTemp->pprev;
     }
@@ -202,7 +234,7 @@ arith_uint256 GetBlockProof(const CBlockIndex &block) {
 
     for (blocksSinceHive = 0; blocksSinceHive < consensusParams.maxKPow;
          blocksSinceHive++) {
-      if (currBlock->GetBlockHeader().IsHiveMined(consensusParams)) {
+      if (currBlock->IsHiveMined(consensusParams)) {
         lastHiveDifficulty = GetDifficulty(currBlock, true);
         if (verbose)
           LogPrintf("**** Got last Hive diff = %.12f, at %s\n",
@@ -246,11 +278,11 @@ arith_uint256 GetNumHashes(const CBlockIndex &block, POW_TYPE powType) {
 
   bnTarget.SetCompact(block.nBits, &fNegative, &fOverflow);
   if (fNegative || fOverflow || bnTarget == 0 ||
-      block.GetBlockHeader().IsHiveMined(Params().GetConsensus()))
+      block.IsHiveMined(Params().GetConsensus()))
     return 0;
 
   if (IsMinotaurXEnabled(&block, Params().GetConsensus()) &&
-      block.GetBlockHeader().GetPoWType() != powType)
+      block.GetPoWType() != powType)
     return 0;
 
   if (!IsMinotaurXEnabled(&block, Params().GetConsensus()) &&
@@ -144,6 +144,8 @@ enum BlockStatus : uint32_t {
 
   BLOCK_OPT_WITNESS = 128,
 
+  BLOCK_PROOF_VALID = 256,
+
 };
 
 class CBlockIndex {
@@ -151,6 +153,7 @@ public:
   arith_uint256 nChainWork;
   CBlockIndex *pprev;
   CBlockIndex *pskip;
+  CBlockIndex *pprevSameKind;
 
   const uint256 *phashBlock;
   int nFile;
@@ -181,6 +184,7 @@ public:
     phashBlock = nullptr;
     pprev = nullptr;
     pskip = nullptr;
+    pprevSameKind = nullptr;
     nHeight = 0;
     nFile = 0;
     nDataPos = 0;
@@ -244,10 +248,18 @@ public:
 
   uint256 GetBlockHash() const { return *phashBlock; }
 
-  uint256 GetBlockPoWHash() const { return GetBlockHeader().GetPoWHash(); }
+  uint256 GetBlockPoWHash() const {
+    return GetBlockHeader().GetPoWHash(GetBlockHash());
+  }
 
   int64_t GetBlockTime() const { return (int64_t)nTime; }
 
+  bool IsHiveMined(const Consensus::Params &consensusParams) const {
+    return (nNonce == consensusParams.hiveNonceMarker);
+  }
+
+  POW_TYPE GetPoWType() const { return (POW_TYPE)((nVersion >> 16) & 0xFF); }
+
   int64_t GetBlockTimeMax() const { return (int64_t)nTimeMax; }
 
   static constexpr int nMedianTimeSpan = 11;
@@ -293,6 +305,8 @@ public:
 
   void BuildSkip();
 
+  void BuildPrevSameKind(const Consensus::Params &consensusParams);
+
   CBlockIndex *GetAncestor(int height);
   const CBlockIndex *GetAncestor(int height) const;
 
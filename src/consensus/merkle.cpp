@@ -3,6 +3,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <consensus/merkle.h>
+#include <crypto/sha256.h>
 #include <hash.h>
 #include <utilstrencodings.h>
 
@@ -94,10 +95,26 @@ static void MerkleComputation(const std::vector<uint256> &leaves,
     *proot = h;
 }
 
-uint256 ComputeMerkleRoot(const std::vector<uint256> &leaves, bool *mutated) {
-  uint256 hash;
-  MerkleComputation(leaves, &hash, mutated, -1, nullptr);
-  return hash;
+uint256 ComputeMerkleRoot(std::vector<uint256> hashes, bool *mutated) {
+  bool mutation = false;
+  while (hashes.size() > 1) {
+    if (mutated) {
+      for (size_t pos = 0; pos + 1 < hashes.size(); pos += 2) {
+        if (hashes[pos] == hashes[pos + 1])
+          mutation = true;
+      }
+    }
+    if (hashes.size() & 1) {
+      hashes.push_back(hashes.back());
+    }
+    SHA256D64(hashes[0].begin(), hashes[0].begin(), hashes.size() / 2);
+    hashes.resize(hashes.size() / 2);
+  }
+  if (mutated)
+    *mutated = mutation;
+  if (hashes.size() == 0)
+    return uint256();
+  return hashes[0];
 }
 
 std::vector<uint256> ComputeMerkleBranch(const std::vector<uint256> &leaves,
@@ -129,7 +146,7 @@ uint256 BlockMerkleRoot(const CBlock &block, bool *mutated) {
   for (size_t s = 0; s < block.vtx.size(); s++) {
     leaves[s] = block.vtx[s]->GetHash();
   }
-  return ComputeMerkleRoot(leaves, mutated);
+  return ComputeMerkleRoot(std::move(leaves), mutated);
 }
 
 uint256 BlockWitnessMerkleRoot(const CBlock &block, bool *mutated) {
@@ -140,7 +157,7 @@ uint256 BlockWitnessMerkleRoot(const CBlock &block, bool *mutated) {
   for (size_t s = 1; s < block.vtx.size(); s++) {
     leaves[s] = block.vtx[s]->GetWitnessHash();
   }
-  return ComputeMerkleRoot(leaves, mutated);
+  return ComputeMerkleRoot(std::move(leaves), mutated);
 }
 
 std::vector<uint256> BlockMerkleBranch(const CBlock &block, uint32_t position) {
@@ -12,8 +12,7 @@
 #include <primitives/transaction.h>
 #include <uint256.h>
 
-uint256 ComputeMerkleRoot(const std::vector<uint256> &leaves,
-                          bool *mutated = nullptr);
+uint256 ComputeMerkleRoot(std::vector<uint256> hashes, bool *mutated = nullptr);
 std::vector<uint256> ComputeMerkleBranch(const std::vector<uint256> &leaves,
                                          uint32_t position);
 uint256 ComputeMerkleRootFromBranch(const uint256 &leaf,
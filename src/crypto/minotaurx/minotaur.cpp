@@ -0,0 +1,176 @@
+// Copyright (c) 2019-2021 The Litecoin Cash Core developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <crypto/minotaurx/minotaur.h>
+
+#include <assert.h>
+#include <stdio.h>
+
+static const yespower_params_t yespower_params = {YESPOWER_1_0, 2048, 8, (const uint8_t*)"et in arcadia ego", 17};
+
+// Children of each node in the torture garden: {even last byte, odd last byte}. -1 ends the traversal.
+// Note that both sides of 19 and 20 lead to 21, and 21 has no children (to make traversal complete).
+// Every path through the garden stops at 7 nodes.
+static const int8_t gardenLinks[22][2] = {
+    {1, 2}, {3, 4}, {5, 6}, {7, 8}, {9, 10}, {11, 12}, {13, 14},
+    {15, 16}, {15, 16}, {15, 16}, {15, 16},
+    {17, 18}, {17, 18}, {17, 18}, {17, 18},
+    {19, 20}, {19, 20}, {19, 20}, {19, 20},
+    {21, 21}, {21, 21},
+    {-1, -1}
+};
+
+MinotaurHasher::MinotaurHasher()
+{
+    yespower_init_local(&local);
+}
+
+MinotaurHasher::~MinotaurHasher()
+{
+    yespower_free_local(&local);
+}
+
+MinotaurHasher& MinotaurHasher::ForThisThread()
+{
+    static thread_local MinotaurHasher hasher;
+    return hasher;
+}
+
+// Get a 64-byte hash for given 64-byte input, using the given algo index
+uint512 MinotaurHasher::HashNode(const uint512 &inputHash, unsigned int algo)
+{
+    uint512 outputHash;
+    switch (algo) {
+        case 0:
+            sph_blake512_init(&garden.context_blake);
+            sph_blake512(&garden.context_blake, static_cast<const void*>(&inputHash), 64);
+            sph_blake512_close(&garden.context_blake, static_cast<void*>(&outputHash));
+            break;
+        case 1:
+            sph_bmw512_init(&garden.context_bmw);
+            sph_bmw512(&garden.context_bmw, static_cast<const void*>(&inputHash), 64);
+            sph_bmw512_close(&garden.context_bmw, static_cast<void*>(&outputHash));        
+            break;
+        case 2:
+            sph_cubehash512_init(&garden.context_cubehash);
+            sph_cubehash512(&garden.context_cubehash, static_cast<const void*>(&inputHash), 64);
+            sph_cubehash512_close(&garden.context_cubehash, static_cast<void*>(&outputHash));
+            break;
+        case 3:
+            sph_echo512_init(&garden.context_echo);
+            sph_echo512(&garden.context_echo, static_cast<const void*>(&inputHash), 64);
+            sph_echo512_close(&garden.context_echo, static_cast<void*>(&outputHash));
+            break;
+        case 4:
+            sph_fugue512_init(&garden.context_fugue);
+            sph_fugue512(&garden.context_fugue, static_cast<const void*>(&inputHash), 64);
+            sph_fugue512_close(&garden.context_fugue, static_cast<void*>(&outputHash));
+            break;
+        case 5:
+            sph_groestl512_init(&garden.context_groestl);
+            sph_groestl512(&garden.context_groestl, static_cast<const void*>(&inputHash), 64);
+            sph_groestl512_close(&garden.context_groestl, static_cast<void*>(&outputHash));
+            break;
+        case 6:
+            sph_hamsi512_init(&garden.context_hamsi);
+            sph_hamsi512(&garden.context_hamsi, static_cast<const void*>(&inputHash), 64);
+            sph_hamsi512_close(&garden.context_hamsi, static_cast<void*>(&outputHash));
+            break;
+        case 7:
+            sph_sha512_init(&garden.context_sha2);
+            sph_sha512(&garden.context_sha2, static_cast<const void*>(&inputHash), 64);
+            sph_sha512_close(&garden.context_sha2, static_cast<void*>(&outputHash));
+            break;
+        case 8:
+            sph_jh512_init(&garden.context_jh);
+            sph_jh512(&garden.context_jh, static_cast<const void*>(&inputHash), 64);
+            sph_jh512_close(&garden.context_jh, static_cast<void*>(&outputHash));
+            break;
+        case 9:
+            sph_keccak512_init(&garden.context_keccak);
+            sph_keccak512(&garden.context_keccak, static_cast<const void*>(&inputHash), 64);
+            sph_keccak512_close(&garden.context_keccak, static_cast<void*>(&outputHash));
+            break;
+        case 10:
+            sph_luffa512_init(&garden.context_luffa);
+            sph_luffa512(&garden.context_luffa, static_cast<const void*>(&inputHash), 64);
+            sph_luffa512_close(&garden.context_luffa, static_cast<void*>(&outputHash));
+            break;
+        case 11:
+            sph_shabal512_init(&garden.context_shabal);
+            sph_shabal512(&garden.context_shabal, static_cast<const void*>(&inputHash), 64);
+            sph_shabal512_close(&garden.context_shabal, static_cast<void*>(&outputHash));
+            break;
+        case 12:
+            sph_shavite512_init(&garden.context_shavite);
+            sph_shavite512(&garden.context_shavite, static_cast<const void*>(&inputHash), 64);
+            sph_shavite512_close(&garden.context_shavite, static_cast<void*>(&outputHash));
+            break;
+        case 13:
+            sph_simd512_init(&garden.context_simd);
+            sph_simd512(&garden.context_simd, static_cast<const void*>(&inputHash), 64);
+            sph_simd512_close(&garden.context_simd, static_cast<void*>(&outputHash));
+            break;
+        case 14:
+            sph_skein512_init(&garden.context_skein);
+            sph_skein512(&garden.context_skein, static_cast<const void*>(&inputHash), 64);
+            sph_skein512_close(&garden.context_skein, static_cast<void*>(&outputHash));
+            break;
+        case 15:
+            sph_whirlpool_init(&garden.context_whirlpool);
+            sph_whirlpool(&garden.context_whirlpool, static_cast<const void*>(&inputHash), 64);
+            sph_whirlpool_close(&garden.context_whirlpool, static_cast<void*>(&outputHash));
+            break;
+        // NB: The CPU-hard gate must be case MINOTAUR_ALGO_COUNT.
+        case 16:
+            yespower(&local, inputHash.begin(), 64, &yespower_params, (yespower_binary_t*)outputHash.begin());
+            break;
+        default:
+            assert(false);
+            break;
+    }
+
+    return outputHash;
+}
+
+uint256 MinotaurHasher::Hash(const uint8_t *data, size_t len, bool minotaurX)
+{
+    // Find initial sha512 hash of the variable length data
+    uint512 hash;
+    sph_sha512_init(&garden.context_sha2);
+    sph_sha512(&garden.context_sha2, static_cast<const void*>(data), len);
+    sph_sha512_close(&garden.context_sha2, static_cast<void*>(&hash));
+
+#ifdef MINOTAUR_DEBUG
+    printf("** Initial hash:\t\t%s\n", hash.ToString().c_str());
+    fflush(0);
+#endif
+
+    // Assign algos to torture garden nodes based on initial hash
+    unsigned int algos[22];
+    for (int i = 0; i < 22; i++)
+        algos[i] = hash.ByteAt(i) % MINOTAUR_ALGO_COUNT;
+
+    // Hardened garden gates on MinotaurX
+    if (minotaurX)
+        algos[21] = MINOTAUR_ALGO_COUNT;
+
+    // Send the initial hash through the torture garden, taking the left child on an even last byte and the right on an odd one
+    for (int node = 0; node != -1; node = gardenLinks[node][hash.ByteAt(63) & 1]) {
+        hash = HashNode(hash, algos[node]);
+
+#ifdef MINOTAUR_DEBUG
+        printf("* Ran algo %d. Partial hash:\t%s\n", algos[node], hash.ToString().c_str());
+        fflush(0);
+#endif
+    }
+
+#ifdef MINOTAUR_DEBUG
+    printf("** Final hash:\t\t\t%s\n", uint256(hash).ToString().c_str());
+    fflush(0);
+#endif
+
+    // Return truncated result
+    return uint256(hash);
+}
@@ -0,0 +1,124 @@
+// Copyright (c) 2024 The Litecoin Cash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+//
+// This is an 8-way AVX2 scrypt(1024,1,1) core: it runs eight independent
+// scrypt ROMix computations side by side, one per 32-bit lane of a 256-bit
+// register. PBKDF2 pre- and post-processing stays in scrypt.cpp.
+
+#ifdef ENABLE_AVX2
+
+#include <stdint.h>
+#include <immintrin.h>
+
+#define SALSA8_R(a, b) _mm256_or_si256(_mm256_slli_epi32((a), (b)), _mm256_srli_epi32((a), 32 - (b)))
+#define SALSA8_STEP(d, a, b, r) d = _mm256_xor_si256(d, SALSA8_R(_mm256_add_epi32(a, b), r))
+
+/* Salsa20/8 on eight independent blocks, word k of lane n in element n of B[k]. */
+static inline void xor_salsa8_8way(__m256i B[16], const __m256i Bx[16])
+{
+	__m256i x00, x01, x02, x03, x04, x05, x06, x07;
+	__m256i x08, x09, x10, x11, x12, x13, x14, x15;
+	int i;
+
+	x00 = (B[ 0] = _mm256_xor_si256(B[ 0], Bx[ 0]));
+	x01 = (B[ 1] = _mm256_xor_si256(B[ 1], Bx[ 1]));
+	x02 = (B[ 2] = _mm256_xor_si256(B[ 2], Bx[ 2]));
+	x03 = (B[ 3] = _mm256_xor_si256(B[ 3], Bx[ 3]));
+	x04 = (B[ 4] = _mm256_xor_si256(B[ 4], Bx[ 4]));
+	x05 = (B[ 5] = _mm256_xor_si256(B[ 5], Bx[ 5]));
+	x06 = (B[ 6] = _mm256_xor_si256(B[ 6], Bx[ 6]));
+	x07 = (B[ 7] = _mm256_xor_si256(B[ 7], Bx[ 7]));
+	x08 = (B[ 8] = _mm256_xor_si256(B[ 8], Bx[ 8]));
+	x09 = (B[ 9] = _mm256_xor_si256(B[ 9], Bx[ 9]));
+	x10 = (B[10] = _mm256_xor_si256(B[10], Bx[10]));
+	x11 = (B[11] = _mm256_xor_si256(B[11], Bx[11]));
+	x12 = (B[12] = _mm256_xor_si256(B[12], Bx[12]));
+	x13 = (B[13] = _mm256_xor_si256(B[13], Bx[13]));
+	x14 = (B[14] = _mm256_xor_si256(B[14], Bx[14]));
+	x15 = (B[15] = _mm256_xor_si256(B[15], Bx[15]));
+	for (i = 0; i < 8; i += 2) {
+		/* Operate on columns. */
+		SALSA8_STEP(x04, x00, x12, 7);
+		SALSA8_STEP(x09, x05, x01, 7);
+		SALSA8_STEP(x14, x10, x06, 7);
+		SALSA8_STEP(x03, x15, x11, 7);
+		SALSA8_STEP(x08, x04, x00, 9);
+		SALSA8_STEP(x13, x09, x05, 9);
+		SALSA8_STEP(x02, x14, x10, 9);
+		SALSA8_STEP(x07, x03, x15, 9);
+		SALSA8_STEP(x12, x08, x04, 13);
+		SALSA8_STEP(x01, x13, x09, 13);
+		SALSA8_STEP(x06, x02, x14, 13);
+		SALSA8_STEP(x11, x07, x03, 13);
+		SALSA8_STEP(x00, x12, x08, 18);
+		SALSA8_STEP(x05, x01, x13, 18);
+		SALSA8_STEP(x10, x06, x02, 18);
+		SALSA8_STEP(x15, x11, x07, 18);
+		/* Operate on rows. */
+		SALSA8_STEP(x01, x00, x03, 7);
+		SALSA8_STEP(x06, x05, x04, 7);
+		SALSA8_STEP(x11, x10, x09, 7);
+		SALSA8_STEP(x12, x15, x14, 7);
+		SALSA8_STEP(x02, x01, x00, 9);
+		SALSA8_STEP(x07, x06, x05, 9);
+		SALSA8_STEP(x08, x11, x10, 9);
+		SALSA8_STEP(x13, x12, x15, 9);
+		SALSA8_STEP(x03, x02, x01, 13);
+		SALSA8_STEP(x04, x07, x06, 13);
+		SALSA8_STEP(x09, x08, x11, 13);
+		SALSA8_STEP(x14, x13, x12, 13);
+		SALSA8_STEP(x00, x03, x02, 18);
+		SALSA8_STEP(x05, x04, x07, 18);
+		SALSA8_STEP(x10, x09, x08, 18);
+		SALSA8_STEP(x15, x14, x13, 18);
+	}
+	B[ 0] = _mm256_add_epi32(B[ 0], x00);
+	B[ 1] = _mm256_add_epi32(B[ 1], x01);
+	B[ 2] = _mm256_add_epi32(B[ 2], x02);
+	B[ 3] = _mm256_add_epi32(B[ 3], x03);
+	B[ 4] = _mm256_add_epi32(B[ 4], x04);
+	B[ 5] = _mm256_add_epi32(B[ 5], x05);
+	B[ 6] = _mm256_add_epi32(B[ 6], x06);
+	B[ 7] = _mm256_add_epi32(B[ 7], x07);
+	B[ 8] = _mm256_add_epi32(B[ 8], x08);
+	B[ 9] = _mm256_add_epi32(B[ 9], x09);
+	B[10] = _mm256_add_epi32(B[10], x10);
+	B[11] = _mm256_add_epi32(B[11], x11);
+	B[12] = _mm256_add_epi32(B[12], x12);
+	B[13] = _mm256_add_epi32(B[13], x13);
+	B[14] = _mm256_add_epi32(B[14], x14);
+	B[15] = _mm256_add_epi32(B[15], x15);
+}
+
+#undef SALSA8_STEP
+#undef SALSA8_R
+
+/*
+ * scrypt ROMix on eight hashes at once, with the same interleaved layout as
+ * scrypt_core_4way_sse2 but 32-byte alignment and 8 * 128 KiB of scratch.
+ */
+void scrypt_core_8way_avx2(uint32_t *X, uint32_t *V)
+{
+	__m256i *Xv = (__m256i *)X;
+	__m256i *Vv = (__m256i *)V;
+	uint32_t i, j, k, lane;
+
+	for (i = 0; i < 1024; i++) {
+		for (k = 0; k < 32; k++)
+			Vv[i * 32 + k] = Xv[k];
+		xor_salsa8_8way(&Xv[0], &Xv[16]);
+		xor_salsa8_8way(&Xv[16], &Xv[0]);
+	}
+	for (i = 0; i < 1024; i++) {
+		for (lane = 0; lane < 8; lane++) {
+			j = 32 * 8 * (X[16 * 8 + lane] & 1023) + lane;
+			for (k = 0; k < 32; k++)
+				X[k * 8 + lane] ^= V[j + k * 8];
+		}
+		xor_salsa8_8way(&Xv[0], &Xv[16]);
+		xor_salsa8_8way(&Xv[16], &Xv[0]);
+	}
+}
+
+#endif // ENABLE_AVX2
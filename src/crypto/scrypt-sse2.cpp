@@ -137,4 +137,116 @@ void scrypt_1024_1_1_256_sp_sse2(const char *input, char *output, char *scratchp
 	PBKDF2_SHA256((const uint8_t *)input, 80, B, 128, 1, (uint8_t *)output, 32);
 }
 
+#define SALSA4_R(a, b) _mm_or_si128(_mm_slli_epi32((a), (b)), _mm_srli_epi32((a), 32 - (b)))
+#define SALSA4_STEP(d, a, b, r) d = _mm_xor_si128(d, SALSA4_R(_mm_add_epi32(a, b), r))
+
+/* Salsa20/8 on four independent blocks, word k of lane n in element n of B[k]. */
+static inline void xor_salsa8_4way(__m128i B[16], const __m128i Bx[16])
+{
+	__m128i x00, x01, x02, x03, x04, x05, x06, x07;
+	__m128i x08, x09, x10, x11, x12, x13, x14, x15;
+	int i;
+
+	x00 = (B[ 0] = _mm_xor_si128(B[ 0], Bx[ 0]));
+	x01 = (B[ 1] = _mm_xor_si128(B[ 1], Bx[ 1]));
+	x02 = (B[ 2] = _mm_xor_si128(B[ 2], Bx[ 2]));
+	x03 = (B[ 3] = _mm_xor_si128(B[ 3], Bx[ 3]));
+	x04 = (B[ 4] = _mm_xor_si128(B[ 4], Bx[ 4]));
+	x05 = (B[ 5] = _mm_xor_si128(B[ 5], Bx[ 5]));
+	x06 = (B[ 6] = _mm_xor_si128(B[ 6], Bx[ 6]));
+	x07 = (B[ 7] = _mm_xor_si128(B[ 7], Bx[ 7]));
+	x08 = (B[ 8] = _mm_xor_si128(B[ 8], Bx[ 8]));
+	x09 = (B[ 9] = _mm_xor_si128(B[ 9], Bx[ 9]));
+	x10 = (B[10] = _mm_xor_si128(B[10], Bx[10]));
+	x11 = (B[11] = _mm_xor_si128(B[11], Bx[11]));
+	x12 = (B[12] = _mm_xor_si128(B[12], Bx[12]));
+	x13 = (B[13] = _mm_xor_si128(B[13], Bx[13]));
+	x14 = (B[14] = _mm_xor_si128(B[14], Bx[14]));
+	x15 = (B[15] = _mm_xor_si128(B[15], Bx[15]));
+	for (i = 0; i < 8; i += 2) {
+		/* Operate on columns. */
+		SALSA4_STEP(x04, x00, x12, 7);
+		SALSA4_STEP(x09, x05, x01, 7);
+		SALSA4_STEP(x14, x10, x06, 7);
+		SALSA4_STEP(x03, x15, x11, 7);
+		SALSA4_STEP(x08, x04, x00, 9);
+		SALSA4_STEP(x13, x09, x05, 9);
+		SALSA4_STEP(x02, x14, x10, 9);
+		SALSA4_STEP(x07, x03, x15, 9);
+		SALSA4_STEP(x12, x08, x04, 13);
+		SALSA4_STEP(x01, x13, x09, 13);
+		SALSA4_STEP(x06, x02, x14, 13);
+		SALSA4_STEP(x11, x07, x03, 13);
+		SALSA4_STEP(x00, x12, x08, 18);
+		SALSA4_STEP(x05, x01, x13, 18);
+		SALSA4_STEP(x10, x06, x02, 18);
+		SALSA4_STEP(x15, x11, x07, 18);
+		/* Operate on rows. */
+		SALSA4_STEP(x01, x00, x03, 7);
+		SALSA4_STEP(x06, x05, x04, 7);
+		SALSA4_STEP(x11, x10, x09, 7);
+		SALSA4_STEP(x12, x15, x14, 7);
+		SALSA4_STEP(x02, x01, x00, 9);
+		SALSA4_STEP(x07, x06, x05, 9);
+		SALSA4_STEP(x08, x11, x10, 9);
+		SALSA4_STEP(x13, x12, x15, 9);
+		SALSA4_STEP(x03, x02, x01, 13);
+		SALSA4_STEP(x04, x07, x06, 13);
+		SALSA4_STEP(x09, x08, x11, 13);
+		SALSA4_STEP(x14, x13, x12, 13);
+		SALSA4_STEP(x00, x03, x02, 18);
+		SALSA4_STEP(x05, x04, x07, 18);
+		SALSA4_STEP(x10, x09, x08, 18);
+		SALSA4_STEP(x15, x14, x13, 18);
+	}
+	B[ 0] = _mm_add_epi32(B[ 0], x00);
+	B[ 1] = _mm_add_epi32(B[ 1], x01);
+	B[ 2] = _mm_add_epi32(B[ 2], x02);
+	B[ 3] = _mm_add_epi32(B[ 3], x03);
+	B[ 4] = _mm_add_epi32(B[ 4], x04);
+	B[ 5] = _mm_add_epi32(B[ 5], x05);
+	B[ 6] = _mm_add_epi32(B[ 6], x06);
+	B[ 7] = _mm_add_epi32(B[ 7], x07);
+	B[ 8] = _mm_add_epi32(B[ 8], x08);
+	B[ 9] = _mm_add_epi32(B[ 9], x09);
+	B[10] = _mm_add_epi32(B[10], x10);
+	B[11] = _mm_add_epi32(B[11], x11);
+	B[12] = _mm_add_epi32(B[12], x12);
+	B[13] = _mm_add_epi32(B[13], x13);
+	B[14] = _mm_add_epi32(B[14], x14);
+	B[15] = _mm_add_epi32(B[15], x15);
+}
+
+#undef SALSA4_STEP
+#undef SALSA4_R
+
+/*
+ * scrypt ROMix on four hashes at once.  X holds the 32 words of each state
+ * interleaved by lane (word k of lane n at X[k * 4 + n]) and must be 16-byte
+ * aligned; V must provide 4 * 128 KiB of 16-byte aligned scratch.  Only the
+ * data-dependent reads from V are done lane by lane.
+ */
+void scrypt_core_4way_sse2(uint32_t *X, uint32_t *V)
+{
+	__m128i *Xv = (__m128i *)X;
+	__m128i *Vv = (__m128i *)V;
+	uint32_t i, j, k, lane;
+
+	for (i = 0; i < 1024; i++) {
+		for (k = 0; k < 32; k++)
+			Vv[i * 32 + k] = Xv[k];
+		xor_salsa8_4way(&Xv[0], &Xv[16]);
+		xor_salsa8_4way(&Xv[16], &Xv[0]);
+	}
+	for (i = 0; i < 1024; i++) {
+		for (lane = 0; lane < 4; lane++) {
+			j = 32 * 4 * (X[16 * 4 + lane] & 1023) + lane;
+			for (k = 0; k < 32; k++)
+				X[k * 4 + lane] ^= V[j + k * 4];
+		}
+		xor_salsa8_4way(&Xv[0], &Xv[16]);
+		xor_salsa8_4way(&Xv[16], &Xv[0]);
+	}
+}
+
 #endif // USE_SSE2
@@ -27,6 +27,10 @@
  * online backup system.
  */
 
+#if defined(HAVE_CONFIG_H)
+#include "config/bitcoin-config.h"
+#endif
+
 #include "crypto/scrypt.h"
 //#include "util.h"
 #include <stdlib.h>
@@ -44,6 +48,14 @@
 #include <cpuid.h>
 #endif
 #endif
+
+#if defined(__x86_64__) || defined(__amd64__) || defined(__i386__)
+#if (defined(USE_SSE2) || defined(ENABLE_AVX2)) && !defined(BUILD_BITCOIN_INTERNAL) && !defined(_MSC_VER)
+#include <cpuid.h>
+#define USE_MULTIWAY_SCRYPT
+#endif
+#endif
+
 #if !defined(__FreeBSD__) && !defined(__APPLE__)
 static inline uint32_t be32dec(const void *pp)
 {
@@ -331,3 +343,119 @@ void scrypt_1024_1_1_256(const char *input, char *output)
 	char scratchpad[SCRYPT_SCRATCHPAD_SIZE];
     scrypt_1024_1_1_256_sp(input, output, scratchpad);
 }
+
+#ifdef USE_MULTIWAY_SCRYPT
+#if defined(USE_SSE2)
+void scrypt_core_4way_sse2(uint32_t *X, uint32_t *V);
+#endif
+#if defined(ENABLE_AVX2)
+void scrypt_core_8way_avx2(uint32_t *X, uint32_t *V);
+#endif
+
+// Set by scrypt_detect_multiway(); until then batches are hashed one by one.
+static void (*scrypt_core_multi)(uint32_t *X, uint32_t *V) = NULL;
+static unsigned int scrypt_multi_ways = 1;
+
+static void scrypt_1024_1_1_256_nway(const char *input, char *output, uint32_t *X, uint32_t *V)
+{
+	const unsigned int ways = scrypt_multi_ways;
+	uint8_t B[128];
+	uint32_t k, lane;
+
+	for (lane = 0; lane < ways; lane++) {
+		const uint8_t *in = (const uint8_t *)input + 80 * lane;
+		PBKDF2_SHA256(in, 80, in, 80, 1, B, 128);
+		for (k = 0; k < 32; k++)
+			X[k * ways + lane] = le32dec(&B[4 * k]);
+	}
+
+	scrypt_core_multi(X, V);
+
+	for (lane = 0; lane < ways; lane++) {
+		for (k = 0; k < 32; k++)
+			le32enc(&B[4 * k], X[k * ways + lane]);
+		PBKDF2_SHA256((const uint8_t *)input + 80 * lane, 80, B, 128, 1, (uint8_t *)output + 32 * lane, 32);
+	}
+}
+
+static bool scrypt_selftest_multiway()
+{
+	char input[80 * 8], output[32 * 8], expected[32];
+	char scratchpad[SCRYPT_SCRATCHPAD_SIZE];
+	unsigned int i;
+
+	for (i = 0; i < sizeof(input); i++)
+		input[i] = (char)(i * 7 + 3);
+	scrypt_1024_1_1_256_multi(input, output, scrypt_multi_ways);
+	for (i = 0; i < scrypt_multi_ways; i++) {
+		scrypt_1024_1_1_256_sp_generic(input + 80 * i, expected, scratchpad);
+		if (memcmp(expected, output + 32 * i, 32) != 0)
+			return false;
+	}
+	return true;
+}
+#endif // USE_MULTIWAY_SCRYPT
+
+std::string scrypt_detect_multiway()
+{
+	std::string ret = "scrypt: batches hashed one at a time";
+#ifdef USE_MULTIWAY_SCRYPT
+	uint32_t a, b, c, d;
+	bool have_sse2 = false, have_avx2 = false;
+
+	scrypt_core_multi = NULL;
+	scrypt_multi_ways = 1;
+	if (__get_cpuid(1, &a, &b, &c, &d)) {
+		have_sse2 = (d >> 26) & 1;
+		// AVX2 also needs the OS to save the YMM registers (OSXSAVE, then XCR0 bits 1 and 2).
+		if (((c >> 27) & 1) && ((c >> 28) & 1) && __get_cpuid_max(0, NULL) >= 7) {
+			uint32_t xcr0_lo, xcr0_hi;
+			__asm__("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+			__cpuid_count(7, 0, a, b, c, d);
+			have_avx2 = (xcr0_lo & 6) == 6 && ((b >> 5) & 1);
+		}
+	}
+#if defined(USE_SSE2)
+	if (have_sse2) {
+		scrypt_core_multi = &scrypt_core_4way_sse2;
+		scrypt_multi_ways = 4;
+		ret = "scrypt: batches hashed 4-way with sse2";
+	}
+#endif
+#if defined(ENABLE_AVX2)
+	if (have_avx2) {
+		scrypt_core_multi = &scrypt_core_8way_avx2;
+		scrypt_multi_ways = 8;
+		ret = "scrypt: batches hashed 8-way with avx2";
+	}
+#endif
+	if (scrypt_core_multi && !scrypt_selftest_multiway()) {
+		scrypt_core_multi = NULL;
+		scrypt_multi_ways = 1;
+		ret = "scrypt: multi-way self-test failed, batches hashed one at a time";
+	}
+#endif // USE_MULTIWAY_SCRYPT
+	return ret;
+}
+
+void scrypt_1024_1_1_256_multi(const char *input, char *output, size_t count)
+{
+#ifdef USE_MULTIWAY_SCRYPT
+	if (scrypt_core_multi && count >= scrypt_multi_ways) {
+		char *scratchpad = (char *)malloc(SCRYPT_SCRATCHPAD_SIZE * scrypt_multi_ways);
+		if (scratchpad) {
+			alignas(32) uint32_t X[32 * 8];
+			uint32_t *V = (uint32_t *)(((uintptr_t)(scratchpad) + 63) & ~ (uintptr_t)(63));
+			while (count >= scrypt_multi_ways) {
+				scrypt_1024_1_1_256_nway(input, output, X, V);
+				input += 80 * scrypt_multi_ways;
+				output += 32 * scrypt_multi_ways;
+				count -= scrypt_multi_ways;
+			}
+			free(scratchpad);
+		}
+	}
+#endif
+	for (; count > 0; count--, input += 80, output += 32)
+		scrypt_1024_1_1_256(input, output);
+}
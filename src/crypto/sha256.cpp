@@ -7,6 +7,7 @@
 
 #include <assert.h>
 #include <string.h>
+#include <algorithm>
 #include <atomic>
 
 #if defined(__x86_64__) || defined(__amd64__)
@@ -19,6 +20,27 @@ void Transform(uint32_t* s, const unsigned char* chunk, size_t blocks);
 #endif
 #endif
 
+#if defined(__x86_64__) || defined(__amd64__) || defined(__i386__)
+#if (defined(ENABLE_SSE41) || defined(ENABLE_AVX2)) && !defined(BUILD_BITCOIN_INTERNAL)
+#include <cpuid.h>
+#define USE_MULTIWAY_SHA256
+#endif
+#endif
+
+#if defined(USE_MULTIWAY_SHA256) && defined(ENABLE_SSE41)
+namespace sha256_sse41
+{
+void Transform_4way(uint32_t* s, const unsigned char* chunks);
+}
+#endif
+
+#if defined(USE_MULTIWAY_SHA256) && defined(ENABLE_AVX2)
+namespace sha256_avx2
+{
+void Transform_8way(uint32_t* s, const unsigned char* chunks);
+}
+#endif
+
 // Internal implementation code.
 namespace
 {
@@ -174,21 +196,117 @@ bool SelfTest(TransformType tr) {
 
 TransformType Transform = sha256::Transform;
 
+typedef void (*TransformWayType)(uint32_t*, const unsigned char*);
+
+TransformWayType Transform4 = nullptr;
+TransformWayType Transform8 = nullptr;
+
+/** Padding of a 64-byte message, as a complete second chunk. */
+const unsigned char pad64[64] = {0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                                 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 0};
+
+/** Padding of a 32-byte message, filling the second half of its only chunk. */
+const unsigned char pad32[32] = {0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0};
+
+/** Transform n independent states (8 consecutive words each) by one 64-byte chunk each,
+ *  using the widest multi-way implementation available.
+ */
+void TransformMany(uint32_t* s, const unsigned char* chunks, size_t n)
+{
+    if (Transform8) {
+        for (; n >= 8; n -= 8, s += 64, chunks += 512) Transform8(s, chunks);
+    }
+    if (Transform4) {
+        for (; n >= 4; n -= 4, s += 32, chunks += 256) Transform4(s, chunks);
+    }
+    for (; n > 0; --n, s += 8, chunks += 64) Transform(s, chunks, 1);
+}
+
+/** Set up 8 chunks for FinishDouble: an empty digest half followed by pad32 in each. */
+void InitFinishChunks(unsigned char* chunks)
+{
+    for (int i = 0; i < 8; ++i) {
+        memset(chunks + 64 * i, 0, 32);
+        memcpy(chunks + 64 * i + 32, pad32, 32);
+    }
+}
+
+/** Hash the 32-byte digests held in n (at most 8) finished states once more, writing n hashes to out.
+ *  chunks must have been set up by InitFinishChunks; only the digest halves are overwritten.
+ */
+void FinishDouble(uint32_t* s, size_t n, unsigned char* chunks, unsigned char* out)
+{
+    for (size_t i = 0; i < n; ++i) {
+        for (int j = 0; j < 8; ++j) WriteBE32(chunks + 64 * i + 4 * j, s[8 * i + j]);
+        sha256::Initialize(s + 8 * i);
+    }
+    TransformMany(s, chunks, n);
+    for (size_t i = 0; i < n; ++i) {
+        for (int j = 0; j < 8; ++j) WriteBE32(out + 32 * i + 4 * j, s[8 * i + j]);
+    }
+}
+
+#ifdef USE_MULTIWAY_SHA256
+/** Check the multi-way transforms against the single-way one. */
+bool SelfTestMany()
+{
+    unsigned char in[64 * 16], out[32 * 16], ref[32];
+    for (int i = 0; i < 64 * 16; ++i) in[i] = i * 37 + 11;
+    for (size_t n = 1; n <= 16; n += 3) {
+        SHA256D64(out, in, n);
+        for (size_t i = 0; i < n; ++i) {
+            CSHA256().Write(in + 64 * i, 64).Finalize(ref);
+            CSHA256().Write(ref, 32).Finalize(ref);
+            if (memcmp(out + 32 * i, ref, 32)) return false;
+        }
+    }
+    return true;
+}
+#endif
+
 } // namespace
 
 std::string SHA256AutoDetect()
 {
+    std::string ret = "standard";
 #if defined(USE_ASM) && (defined(__x86_64__) || defined(__amd64__))
     uint32_t eax, ebx, ecx, edx;
     if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx >> 19) & 1) {
         Transform = sha256_sse4::Transform;
-        assert(SelfTest(Transform));
-        return "sse4";
+        ret = "sse4";
     }
 #endif
-
     assert(SelfTest(Transform));
-    return "standard";
+
+#ifdef USE_MULTIWAY_SHA256
+    uint32_t a, b, c, d;
+    bool have_sse41 = false, have_avx2 = false;
+    if (__get_cpuid(1, &a, &b, &c, &d)) {
+        have_sse41 = (c >> 19) & 1;
+        // AVX2 also needs the OS to save the YMM registers (OSXSAVE, then XCR0 bits 1 and 2).
+        if (((c >> 27) & 1) && ((c >> 28) & 1) && __get_cpuid_max(0, nullptr) >= 7) {
+            uint32_t xcr0_lo, xcr0_hi;
+            __asm__("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+            __cpuid_count(7, 0, a, b, c, d);
+            have_avx2 = (xcr0_lo & 6) == 6 && ((b >> 5) & 1);
+        }
+    }
+#ifdef ENABLE_SSE41
+    if (have_sse41) {
+        Transform4 = sha256_sse41::Transform_4way;
+        ret += ",sse41(4way)";
+    }
+#endif
+#ifdef ENABLE_AVX2
+    if (have_avx2) {
+        Transform8 = sha256_avx2::Transform_8way;
+        ret += ",avx2(8way)";
+    }
+#endif
+    assert(SelfTestMany());
+#endif
+
+    return ret;
 }
 
 ////// SHA-256
@@ -247,3 +365,58 @@ CSHA256& CSHA256::Reset()
     sha256::Initialize(s);
     return *this;
 }
+
+void CSHA256::FinalizeDoubleBatch(const unsigned char* tails, size_t tail_len, size_t count, unsigned char* hashes) const
+{
+    size_t bufsize = bytes % 64;
+    if (bufsize + tail_len + 9 > 64) {
+        // The tails do not fit in a single final chunk; hash them one by one.
+        unsigned char hash[OUTPUT_SIZE];
+        for (size_t i = 0; i < count; ++i) {
+            CSHA256(*this).Write(tails + i * tail_len, tail_len).Finalize(hash);
+            CSHA256().Write(hash, OUTPUT_SIZE).Finalize(hashes + i * OUTPUT_SIZE);
+        }
+        return;
+    }
+
+    // Build the final chunk once, and only substitute the tail per message.
+    unsigned char last[64] = {0};
+    memcpy(last, buf, bufsize);
+    last[bufsize + tail_len] = 0x80;
+    WriteBE64(last + 56, (bytes + tail_len) << 3);
+
+    uint32_t states[8 * 8];
+    unsigned char chunks[8 * 64], finish[8 * 64];
+    InitFinishChunks(finish);
+    while (count) {
+        size_t n = std::min<size_t>(count, 8);
+        for (size_t i = 0; i < n; ++i) {
+            memcpy(states + 8 * i, s, sizeof(s));
+            memcpy(chunks + 64 * i, last, 64);
+            memcpy(chunks + 64 * i + bufsize, tails + i * tail_len, tail_len);
+        }
+        TransformMany(states, chunks, n);
+        FinishDouble(states, n, finish, hashes);
+        tails += n * tail_len;
+        hashes += n * OUTPUT_SIZE;
+        count -= n;
+    }
+}
+
+void SHA256D64(unsigned char* out, const unsigned char* in, size_t blocks)
+{
+    uint32_t states[8 * 8];
+    unsigned char pads[8 * 64], finish[8 * 64];
+    for (int i = 0; i < 8; ++i) memcpy(pads + 64 * i, pad64, 64);
+    InitFinishChunks(finish);
+    while (blocks) {
+        size_t n = std::min<size_t>(blocks, 8);
+        for (size_t i = 0; i < n; ++i) sha256::Initialize(states + 8 * i);
+        TransformMany(states, in, n);
+        TransformMany(states, pads, n);
+        FinishDouble(states, n, finish, out);
+        in += 64 * n;
+        out += 32 * n;
+        blocks -= n;
+    }
+}
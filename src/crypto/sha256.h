@@ -24,8 +24,21 @@ public:
     CSHA256& Write(const unsigned char* data, size_t len);
     void Finalize(unsigned char hash[OUTPUT_SIZE]);
     CSHA256& Reset();
+
+    /** Compute SHA256(SHA256(data || tail)) for count tails of tail_len bytes each, where data is
+     *  what has been written so far, without modifying this object. hashes receives count * 32 bytes.
+     *  Messages that end in the same chunk are processed several at a time by the multi-way transforms.
+     */
+    void FinalizeDoubleBatch(const unsigned char* tails, size_t tail_len, size_t count, unsigned char* hashes) const;
 };
 
+/** Compute multiple double-SHA256's of 64-byte blobs.
+ *  output:  pointer to a blocks*32 byte output buffer
+ *  input:   pointer to a blocks*64 byte input buffer
+ *  blocks:  the number of hashes to compute.
+ */
+void SHA256D64(unsigned char* output, const unsigned char* input, size_t blocks);
+
 /** Autodetect the best available SHA256 implementation.
  *  Returns the name of the implementation.
  */
@@ -0,0 +1,157 @@
+// Copyright (c) 2024 The Litecoin Cash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+//
+// This is a 4-way SSE4.1 SHA-256 transform: it runs four independent
+// SHA-256 compressions side by side, one per 32-bit lane.
+
+#ifdef ENABLE_SSE41
+
+#include <stdint.h>
+#include <immintrin.h>
+
+#include <crypto/common.h>
+
+namespace sha256_sse41
+{
+namespace
+{
+
+__m128i inline K(uint32_t x) { return _mm_set1_epi32(x); }
+
+__m128i inline Add(__m128i x, __m128i y) { return _mm_add_epi32(x, y); }
+__m128i inline Add(__m128i x, __m128i y, __m128i z) { return Add(Add(x, y), z); }
+__m128i inline Add(__m128i x, __m128i y, __m128i z, __m128i w) { return Add(Add(x, y), Add(z, w)); }
+__m128i inline Add(__m128i x, __m128i y, __m128i z, __m128i w, __m128i v) { return Add(Add(x, y, z), Add(w, v)); }
+__m128i inline Xor(__m128i x, __m128i y) { return _mm_xor_si128(x, y); }
+__m128i inline Xor(__m128i x, __m128i y, __m128i z) { return Xor(Xor(x, y), z); }
+__m128i inline Or(__m128i x, __m128i y) { return _mm_or_si128(x, y); }
+__m128i inline And(__m128i x, __m128i y) { return _mm_and_si128(x, y); }
+__m128i inline ShR(__m128i x, int n) { return _mm_srli_epi32(x, n); }
+__m128i inline ShL(__m128i x, int n) { return _mm_slli_epi32(x, n); }
+
+__m128i inline Ch(__m128i x, __m128i y, __m128i z) { return Xor(z, And(x, Xor(y, z))); }
+__m128i inline Maj(__m128i x, __m128i y, __m128i z) { return Or(And(x, y), And(z, Or(x, y))); }
+__m128i inline Sigma0(__m128i x) { return Xor(Or(ShR(x, 2), ShL(x, 30)), Or(ShR(x, 13), ShL(x, 19)), Or(ShR(x, 22), ShL(x, 10))); }
+__m128i inline Sigma1(__m128i x) { return Xor(Or(ShR(x, 6), ShL(x, 26)), Or(ShR(x, 11), ShL(x, 21)), Or(ShR(x, 25), ShL(x, 7))); }
+__m128i inline sigma0(__m128i x) { return Xor(Or(ShR(x, 7), ShL(x, 25)), Or(ShR(x, 18), ShL(x, 14)), ShR(x, 3)); }
+__m128i inline sigma1(__m128i x) { return Xor(Or(ShR(x, 17), ShL(x, 15)), Or(ShR(x, 19), ShL(x, 13)), ShR(x, 10)); }
+
+/** One round of SHA-256. */
+void inline __attribute__((always_inline)) Round(__m128i a, __m128i b, __m128i c, __m128i& d, __m128i e, __m128i f, __m128i g, __m128i& h, __m128i k, __m128i w)
+{
+    __m128i t1 = Add(h, Sigma1(e), Ch(e, f, g), k, w);
+    __m128i t2 = Add(Sigma0(a), Maj(a, b, c));
+    d = Add(d, t1);
+    h = Add(t1, t2);
+}
+
+/** Gather one big-endian message word from each of the four 64-byte chunks. */
+__m128i inline Read(const unsigned char* chunks, int offset)
+{
+    return _mm_set_epi32(ReadBE32(chunks + 192 + offset), ReadBE32(chunks + 128 + offset), ReadBE32(chunks + 64 + offset), ReadBE32(chunks + offset));
+}
+
+/** Gather state word i of each of the four lane-major states. */
+__m128i inline Load(const uint32_t* s, int i)
+{
+    return _mm_set_epi32(s[24 + i], s[16 + i], s[8 + i], s[i]);
+}
+
+/** Scatter x back into state word i of each of the four lane-major states. */
+void inline Store(uint32_t* s, int i, __m128i x)
+{
+    s[i] = _mm_extract_epi32(x, 0);
+    s[8 + i] = _mm_extract_epi32(x, 1);
+    s[16 + i] = _mm_extract_epi32(x, 2);
+    s[24 + i] = _mm_extract_epi32(x, 3);
+}
+
+} // namespace
+
+/** Transform four independent SHA-256 states by one 64-byte chunk each.
+ *  s holds 4 consecutive states of 8 words, chunks holds 4 consecutive chunks.
+ */
+void Transform_4way(uint32_t* s, const unsigned char* chunks)
+{
+    __m128i a = Load(s, 0), b = Load(s, 1), c = Load(s, 2), d = Load(s, 3), e = Load(s, 4), f = Load(s, 5), g = Load(s, 6), h = Load(s, 7);
+    __m128i w0, w1, w2, w3, w4, w5, w6, w7, w8, w9, w10, w11, w12, w13, w14, w15;
+
+    Round(a, b, c, d, e, f, g, h, K(0x428a2f98), w0 = Read(chunks, 0));
+    Round(h, a, b, c, d, e, f, g, K(0x71374491), w1 = Read(chunks, 4));
+    Round(g, h, a, b, c, d, e, f, K(0xb5c0fbcf), w2 = Read(chunks, 8));
+    Round(f, g, h, a, b, c, d, e, K(0xe9b5dba5), w3 = Read(chunks, 12));
+    Round(e, f, g, h, a, b, c, d, K(0x3956c25b), w4 = Read(chunks, 16));
+    Round(d, e, f, g, h, a, b, c, K(0x59f111f1), w5 = Read(chunks, 20));
+    Round(c, d, e, f, g, h, a, b, K(0x923f82a4), w6 = Read(chunks, 24));
+    Round(b, c, d, e, f, g, h, a, K(0xab1c5ed5), w7 = Read(chunks, 28));
+    Round(a, b, c, d, e, f, g, h, K(0xd807aa98), w8 = Read(chunks, 32));
+    Round(h, a, b, c, d, e, f, g, K(0x12835b01), w9 = Read(chunks, 36));
+    Round(g, h, a, b, c, d, e, f, K(0x243185be), w10 = Read(chunks, 40));
+    Round(f, g, h, a, b, c, d, e, K(0x550c7dc3), w11 = Read(chunks, 44));
+    Round(e, f, g, h, a, b, c, d, K(0x72be5d74), w12 = Read(chunks, 48));
+    Round(d, e, f, g, h, a, b, c, K(0x80deb1fe), w13 = Read(chunks, 52));
+    Round(c, d, e, f, g, h, a, b, K(0x9bdc06a7), w14 = Read(chunks, 56));
+    Round(b, c, d, e, f, g, h, a, K(0xc19bf174), w15 = Read(chunks, 60));
+    Round(a, b, c, d, e, f, g, h, K(0xe49b69c1), w0 = Add(w0, sigma1(w14), w9, sigma0(w1)));
+    Round(h, a, b, c, d, e, f, g, K(0xefbe4786), w1 = Add(w1, sigma1(w15), w10, sigma0(w2)));
+    Round(g, h, a, b, c, d, e, f, K(0x0fc19dc6), w2 = Add(w2, sigma1(w0), w11, sigma0(w3)));
+    Round(f, g, h, a, b, c, d, e, K(0x240ca1cc), w3 = Add(w3, sigma1(w1), w12, sigma0(w4)));
+    Round(e, f, g, h, a, b, c, d, K(0x2de92c6f), w4 = Add(w4, sigma1(w2), w13, sigma0(w5)));
+    Round(d, e, f, g, h, a, b, c, K(0x4a7484aa), w5 = Add(w5, sigma1(w3), w14, sigma0(w6)));
+    Round(c, d, e, f, g, h, a, b, K(0x5cb0a9dc), w6 = Add(w6, sigma1(w4), w15, sigma0(w7)));
+    Round(b, c, d, e, f, g, h, a, K(0x76f988da), w7 = Add(w7, sigma1(w5), w0, sigma0(w8)));
+    Round(a, b, c, d, e, f, g, h, K(0x983e5152), w8 = Add(w8, sigma1(w6), w1, sigma0(w9)));
+    Round(h, a, b, c, d, e, f, g, K(0xa831c66d), w9 = Add(w9, sigma1(w7), w2, sigma0(w10)));
+    Round(g, h, a, b, c, d, e, f, K(0xb00327c8), w10 = Add(w10, sigma1(w8), w3, sigma0(w11)));
+    Round(f, g, h, a, b, c, d, e, K(0xbf597fc7), w11 = Add(w11, sigma1(w9), w4, sigma0(w12)));
+    Round(e, f, g, h, a, b, c, d, K(0xc6e00bf3), w12 = Add(w12, sigma1(w10), w5, sigma0(w13)));
+    Round(d, e, f, g, h, a, b, c, K(0xd5a79147), w13 = Add(w13, sigma1(w11), w6, sigma0(w14)));
+    Round(c, d, e, f, g, h, a, b, K(0x06ca6351), w14 = Add(w14, sigma1(w12), w7, sigma0(w15)));
+    Round(b, c, d, e, f, g, h, a, K(0x14292967), w15 = Add(w15, sigma1(w13), w8, sigma0(w0)));
+    Round(a, b, c, d, e, f, g, h, K(0x27b70a85), w0 = Add(w0, sigma1(w14), w9, sigma0(w1)));
+    Round(h, a, b, c, d, e, f, g, K(0x2e1b2138), w1 = Add(w1, sigma1(w15), w10, sigma0(w2)));
+    Round(g, h, a, b, c, d, e, f, K(0x4d2c6dfc), w2 = Add(w2, sigma1(w0), w11, sigma0(w3)));
+    Round(f, g, h, a, b, c, d, e, K(0x53380d13), w3 = Add(w3, sigma1(w1), w12, sigma0(w4)));
+    Round(e, f, g, h, a, b, c, d, K(0x650a7354), w4 = Add(w4, sigma1(w2), w13, sigma0(w5)));
+    Round(d, e, f, g, h, a, b, c, K(0x766a0abb), w5 = Add(w5, sigma1(w3), w14, sigma0(w6)));
+    Round(c, d, e, f, g, h, a, b, K(0x81c2c92e), w6 = Add(w6, sigma1(w4), w15, sigma0(w7)));
+    Round(b, c, d, e, f, g, h, a, K(0x92722c85), w7 = Add(w7, sigma1(w5), w0, sigma0(w8)));
+    Round(a, b, c, d, e, f, g, h, K(0xa2bfe8a1), w8 = Add(w8, sigma1(w6), w1, sigma0(w9)));
+    Round(h, a, b, c, d, e, f, g, K(0xa81a664b), w9 = Add(w9, sigma1(w7), w2, sigma0(w10)));
+    Round(g, h, a, b, c, d, e, f, K(0xc24b8b70), w10 = Add(w10, sigma1(w8), w3, sigma0(w11)));
+    Round(f, g, h, a, b, c, d, e, K(0xc76c51a3), w11 = Add(w11, sigma1(w9), w4, sigma0(w12)));
+    Round(e, f, g, h, a, b, c, d, K(0xd192e819), w12 = Add(w12, sigma1(w10), w5, sigma0(w13)));
+    Round(d, e, f, g, h, a, b, c, K(0xd6990624), w13 = Add(w13, sigma1(w11), w6, sigma0(w14)));
+    Round(c, d, e, f, g, h, a, b, K(0xf40e3585), w14 = Add(w14, sigma1(w12), w7, sigma0(w15)));
+    Round(b, c, d, e, f, g, h, a, K(0x106aa070), w15 = Add(w15, sigma1(w13), w8, sigma0(w0)));
+    Round(a, b, c, d, e, f, g, h, K(0x19a4c116), w0 = Add(w0, sigma1(w14), w9, sigma0(w1)));
+    Round(h, a, b, c, d, e, f, g, K(0x1e376c08), w1 = Add(w1, sigma1(w15), w10, sigma0(w2)));
+    Round(g, h, a, b, c, d, e, f, K(0x2748774c), w2 = Add(w2, sigma1(w0), w11, sigma0(w3)));
+    Round(f, g, h, a, b, c, d, e, K(0x34b0bcb5), w3 = Add(w3, sigma1(w1), w12, sigma0(w4)));
+    Round(e, f, g, h, a, b, c, d, K(0x391c0cb3), w4 = Add(w4, sigma1(w2), w13, sigma0(w5)));
+    Round(d, e, f, g, h, a, b, c, K(0x4ed8aa4a), w5 = Add(w5, sigma1(w3), w14, sigma0(w6)));
+    Round(c, d, e, f, g, h, a, b, K(0x5b9cca4f), w6 = Add(w6, sigma1(w4), w15, sigma0(w7)));
+    Round(b, c, d, e, f, g, h, a, K(0x682e6ff3), w7 = Add(w7, sigma1(w5), w0, sigma0(w8)));
+    Round(a, b, c, d, e, f, g, h, K(0x748f82ee), w8 = Add(w8, sigma1(w6), w1, sigma0(w9)));
+    Round(h, a, b, c, d, e, f, g, K(0x78a5636f), w9 = Add(w9, sigma1(w7), w2, sigma0(w10)));
+    Round(g, h, a, b, c, d, e, f, K(0x84c87814), w10 = Add(w10, sigma1(w8), w3, sigma0(w11)));
+    Round(f, g, h, a, b, c, d, e, K(0x8cc70208), w11 = Add(w11, sigma1(w9), w4, sigma0(w12)));
+    Round(e, f, g, h, a, b, c, d, K(0x90befffa), w12 = Add(w12, sigma1(w10), w5, sigma0(w13)));
+    Round(d, e, f, g, h, a, b, c, K(0xa4506ceb), w13 = Add(w13, sigma1(w11), w6, sigma0(w14)));
+    Round(c, d, e, f, g, h, a, b, K(0xbef9a3f7), Add(w14, sigma1(w12), w7, sigma0(w15)));
+    Round(b, c, d, e, f, g, h, a, K(0xc67178f2), Add(w15, sigma1(w13), w8, sigma0(w0)));
+
+    Store(s, 0, Add(a, Load(s, 0)));
+    Store(s, 1, Add(b, Load(s, 1)));
+    Store(s, 2, Add(c, Load(s, 2)));
+    Store(s, 3, Add(d, Load(s, 3)));
+    Store(s, 4, Add(e, Load(s, 4)));
+    Store(s, 5, Add(f, Load(s, 5)));
+    Store(s, 6, Add(g, Load(s, 6)));
+    Store(s, 7, Add(h, Load(s, 7)));
+}
+
+} // namespace sha256_sse41
+
+#endif
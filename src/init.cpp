@@ -69,9 +69,7 @@
 #include <zmq/zmqnotificationinterface.h>
 #endif
 
-#ifdef USE_SSE2
 #include "crypto/scrypt.h"
-#endif
 
 bool fFeeEstimatesInitialized = false;
 static const bool DEFAULT_PROXYRANDOMIZE = true;
@@ -477,6 +475,27 @@ std::string HelpMessage(HelpMessageMode mode) {
       "-rialto",
       strprintf(_("Support Rialto message propagration (default: %u)"),
                 DEFAULT_RIALTO_SUPPORT));
+  strUsage += HelpMessageOpt(
+      "-rialtopowthreads=<threads>",
+      strprintf(
+          _("Number of threads to use when finding proof of work for outgoing "
+            "Rialto messages, -1 for all available cores, or -2 for one less "
+            "than all available cores (default: %d)"),
+          DEFAULT_RIALTO_POW_THREADS));
+  strUsage += HelpMessageOpt(
+      "-rialtoverifythreads=<threads>",
+      strprintf(_("Number of threads verifying and decrypting inbound Rialto "
+                  "messages off the message handler thread (default: %d)"),
+                DEFAULT_RIALTO_VERIFY_THREADS));
+  strUsage += HelpMessageOpt(
+      "-rialtorecipienttag",
+      strprintf(_("Prefix outgoing Rialto messages with a short recipient tag "
+                  "so hosts of many nicks can skip most trial decryptions. "
+                  "The tag is derived from the recipient's public key, so any "
+                  "relaying node can narrow the recipient down to the white "
+                  "pages nicks sharing that tag. Recipients must run a "
+                  "release that understands tagged envelopes (default: %u)"),
+                DEFAULT_RIALTO_RECIPIENT_TAG));
 
   strUsage +=
       HelpMessageOpt("-peerbloomfilters",
@@ -853,8 +872,9 @@ std::string HelpMessage(HelpMessageMode mode) {
   strUsage += HelpMessageOpt(
       "-hivecheckdelay=<ms>",
       strprintf(
-          _("Time between Hive checks in ms. This should be left at default "
-            "unless performance degradation is observed (default: %u)"),
+          _("Minimum time between Hive checks in ms. Checks start as soon as "
+            "a new tip arrives; raise this only if performance degradation is "
+            "observed (default: %u)"),
           DEFAULT_HIVE_CHECK_DELAY));
   strUsage += HelpMessageOpt(
       "-hivecheckthreads=<threads>",
@@ -1626,8 +1646,10 @@ bool AppInitMain() {
 
   LogPrintf("Using %u threads for script verification\n", nScriptCheckThreads);
   if (nScriptCheckThreads) {
-    for (int i = 0; i < nScriptCheckThreads - 1; i++)
+    for (int i = 0; i < nScriptCheckThreads - 1; i++) {
       threadGroup.create_thread(&ThreadScriptCheck);
+      threadGroup.create_thread(&ThreadPoWCheck);
+    }
   }
 
   CScheduler::Function serviceLoop =
@@ -1656,6 +1678,7 @@ bool AppInitMain() {
   std::string sse2detect = scrypt_detect_sse2();
   LogPrintf("%s\n", sse2detect);
 #endif
+  LogPrintf("%s\n", scrypt_detect_multiway());
 
 #ifdef ENABLE_WALLET
   if (!VerifyWallets())
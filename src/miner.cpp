@@ -28,6 +28,7 @@
 #include <validationinterface.h>
 
 #include <algorithm>
+#include <deque>
 #include <queue>
 #include <utility>
 
@@ -41,6 +42,7 @@
 
 #include <boost/thread.hpp>
 
+#include <crypto/minotaurx/minotaur.h>
 #include <crypto/minotaurx/yespower/yespower.h>
 
 static CCriticalSection cs_solution_vars;
@@ -52,6 +54,207 @@ CBeeRange solvingRange;
 
 uint32_t solvingBee;
 
+int64_t solvingTime;
+
+class CHiveTipListener : public CValidationInterface {
+public:
+  boost::mutex mutex;
+  boost::condition_variable cond;
+  int tipHeight = -1;
+  int checkHeight = -1;
+  int64_t tipTime = 0;
+
+protected:
+  void UpdatedBlockTip(const CBlockIndex *pindexNew,
+                       const CBlockIndex *pindexFork,
+                       bool fInitialDownload) override {
+    {
+      boost::unique_lock<boost::mutex> lock(mutex);
+      tipHeight = pindexNew->nHeight;
+      tipTime = GetTimeMicros();
+      if (checkHeight != -1 && checkHeight != tipHeight)
+        earlyAbort.store(true);
+    }
+    cond.notify_all();
+  }
+};
+
+static CHiveTipListener hiveTipListener;
+
+class CHiveWorkerPool {
+private:
+  boost::mutex mutex;
+  boost::condition_variable condWork;
+  boost::condition_variable condDone;
+  std::vector<boost::thread> threads;
+  uint64_t nRound = 0;
+  int nActive = 0;
+  bool fQuit = false;
+
+  const std::vector<CBeeRange> *chunks = nullptr;
+  std::string deterministicRandString;
+  arith_uint256 beeHashTarget;
+  bool minotaurX = false;
+  std::atomic<size_t> nextChunk{0};
+  std::atomic<int64_t> nBeesChecked{0};
+
+  void CheckChunks(MinotaurHasher &minotaurHasher) {
+    size_t i;
+    int64_t checked = 0;
+    bool fSolved = false;
+    while (!fSolved && (i = nextChunk.fetch_add(1)) < chunks->size()) {
+      if (solutionFound.load() || earlyAbort.load())
+        break;
+
+      const CBeeRange &beeRange = (*chunks)[i];
+      CBeeHasher beeHasher(deterministicRandString, beeRange.txid, minotaurX,
+                           &minotaurHasher);
+      arith_uint256 hashes[BEE_HASH_BATCH];
+      const int end = beeRange.offset + beeRange.count;
+      for (int bee = beeRange.offset; !fSolved && bee < end;
+           bee += BEE_HASH_BATCH) {
+        const int n = std::min(BEE_HASH_BATCH, end - bee);
+        beeHasher.GetHashes(bee, n, hashes);
+        checked += n;
+        for (int j = 0; j < n; j++) {
+          if (hashes[j] < beeHashTarget) {
+            LOCK(cs_solution_vars);
+            if (!solutionFound.load()) {
+              solutionFound.store(true);
+              solvingRange = beeRange;
+              solvingBee = bee + j;
+              solvingTime = GetTimeMicros();
+            }
+            fSolved = true;
+            break;
+          }
+        }
+      }
+    }
+    nBeesChecked.fetch_add(checked);
+  }
+
+  void Worker(uint64_t nLastRound) {
+    RenameThread("hive-worker");
+    // The worker's Minotaur garden and yespower scratch live as long as the
+    // worker and are reused for every bee of every round.
+    MinotaurHasher minotaurHasher;
+    while (true) {
+      {
+        boost::unique_lock<boost::mutex> lock(mutex);
+        while (!fQuit && nRound == nLastRound)
+          condWork.wait(lock);
+        if (fQuit)
+          return;
+        nLastRound = nRound;
+      }
+
+      CheckChunks(minotaurHasher);
+
+      {
+        boost::unique_lock<boost::mutex> lock(mutex);
+        if (--nActive == 0)
+          condDone.notify_all();
+      }
+    }
+  }
+
+public:
+  ~CHiveWorkerPool() { Stop(); }
+
+  int64_t BeesChecked() const { return nBeesChecked.load(); }
+
+  void Stop() {
+    {
+      boost::unique_lock<boost::mutex> lock(mutex);
+      fQuit = true;
+    }
+    condWork.notify_all();
+    for (auto &t : threads)
+      t.join();
+    threads.clear();
+    fQuit = false;
+    nActive = 0;
+  }
+
+  void Run(int threadCount, const std::vector<CBeeRange> &beeChunks,
+           const std::string &deterministicRandStringIn,
+           const arith_uint256 &beeHashTargetIn, bool minotaurXIn) {
+    if ((int)threads.size() != threadCount) {
+      Stop();
+      for (int i = 0; i < threadCount; i++)
+        threads.push_back(
+            boost::thread(&CHiveWorkerPool::Worker, this, nRound));
+    }
+
+    boost::unique_lock<boost::mutex> lock(mutex);
+    chunks = &beeChunks;
+    deterministicRandString = deterministicRandStringIn;
+    beeHashTarget = beeHashTargetIn;
+    minotaurX = minotaurXIn;
+    nextChunk.store(0);
+    nBeesChecked.store(0);
+    nActive = threads.size();
+    nRound++;
+    condWork.notify_all();
+    try {
+      while (nActive > 0)
+        condDone.wait(lock);
+    } catch (const boost::thread_interrupted &) {
+      earlyAbort.store(true);
+      boost::this_thread::disable_interruption noInterruption;
+      while (nActive > 0)
+        condDone.wait(lock);
+      chunks = nullptr;
+      throw;
+    }
+    chunks = nullptr;
+  }
+};
+
+static CHiveWorkerPool hiveWorkerPool;
+
+static CCriticalSection cs_hiveCheckRounds;
+static std::deque<CHiveCheckRound> hiveCheckRounds;
+
+static std::string FormatHiveMicros(int64_t micros) {
+  if (micros < 0)
+    return "n/a";
+  return strprintf("%.3fms", micros * 0.001);
+}
+
+static void RecordHiveCheckRound(const CHiveCheckRound &round) {
+  LogPrint(BCLog::HIVE,
+           "BusyBees: Round at height %i (%s): tip to start %s, GetBCTs %s, "
+           "binning %s, hashing %s, solution to submit %s, %i/%i bees "
+           "checked, %.0f bees/s per thread (%i threads)\n",
+           round.nHeight, round.result,
+           FormatHiveMicros(round.nTipToStartMicros),
+           FormatHiveMicros(round.nGetBCTsMicros),
+           FormatHiveMicros(round.nBinningMicros),
+           FormatHiveMicros(round.nHashingMicros),
+           FormatHiveMicros(round.nSubmitMicros), round.nBeesChecked,
+           round.nBees, round.BeesPerSecondPerThread(), round.nThreads);
+
+  LOCK(cs_hiveCheckRounds);
+  hiveCheckRounds.push_back(round);
+  if (hiveCheckRounds.size() > HIVE_STATS_ROUNDS)
+    hiveCheckRounds.pop_front();
+}
+
+std::vector<CHiveCheckRound> GetHiveCheckRounds() {
+  LOCK(cs_hiveCheckRounds);
+  return std::vector<CHiveCheckRound>(hiveCheckRounds.begin(),
+                                      hiveCheckRounds.end());
+}
+
+class CHiveCheckRoundRecorder {
+public:
+  CHiveCheckRound round;
+
+  ~CHiveCheckRoundRecorder() { RecordHiveCheckRound(round); }
+};
+
 uint64_t nLastBlockTx = 0;
 uint64_t nLastBlockWeight = 0;
 
@@ -498,131 +701,50 @@ void BeeKeeper(const CChainParams &chainparams) {
   LogPrintf("BeeKeeper: Thread started\n");
   RenameThread("hive-beekeeper");
 
+  RegisterValidationInterface(&hiveTipListener);
+
   int height;
   {
     LOCK(cs_main);
     height = chainActive.Tip()->nHeight;
   }
 
+  int64_t lastCheckTime = 0;
   try {
     while (true) {
-      int sleepTime =
+      {
+        boost::unique_lock<boost::mutex> lock(hiveTipListener.mutex);
+        while (hiveTipListener.tipHeight == -1 ||
+               hiveTipListener.tipHeight == height)
+          hiveTipListener.cond.wait(lock);
+      }
+
+      int64_t minDelay =
           std::max((int64_t)1,
                    gArgs.GetArg("-hivecheckdelay", DEFAULT_HIVE_CHECK_DELAY));
-      MilliSleep(sleepTime);
+      int64_t sinceLastCheck = GetTimeMillis() - lastCheckTime;
+      if (sinceLastCheck < minDelay)
+        MilliSleep(minDelay - sinceLastCheck);
 
-      int newHeight;
       {
-        LOCK(cs_main);
-        newHeight = chainActive.Tip()->nHeight;
+        boost::unique_lock<boost::mutex> lock(hiveTipListener.mutex);
+        height = hiveTipListener.tipHeight;
       }
-      if (newHeight != height) {
-        height = newHeight;
-        try {
-          BusyBees(consensusParams, height);
-        } catch (const std::runtime_error &e) {
-          LogPrintf("! BeeKeeper: Error: %s\n", e.what());
-        }
+      lastCheckTime = GetTimeMillis();
+      try {
+        BusyBees(consensusParams, height);
+      } catch (const std::runtime_error &e) {
+        LogPrintf("! BeeKeeper: Error: %s\n", e.what());
       }
     }
   } catch (const boost::thread_interrupted &) {
+    UnregisterValidationInterface(&hiveTipListener);
+    hiveWorkerPool.Stop();
     LogPrintf("!!! BeeKeeper: FATAL: Thread interrupted\n");
     throw;
   }
 }
 
-void AbortWatchThread(int height) {
-  while (true) {
-    MilliSleep(1);
-
-    if (solutionFound.load() || earlyAbort.load())
-      return;
-
-    int newHeight;
-    {
-      LOCK(cs_main);
-      newHeight = chainActive.Tip()->nHeight;
-    }
-
-    if (newHeight != height) {
-      earlyAbort.store(true);
-      return;
-    }
-  }
-}
-
-void CheckBin(int threadID, std::vector<CBeeRange> bin,
-              std::string deterministicRandString,
-              arith_uint256 beeHashTarget) {
-  int checkCount = 0;
-  for (std::vector<CBeeRange>::const_iterator it = bin.begin(); it != bin.end();
-       it++) {
-    CBeeRange beeRange = *it;
-
-    for (int i = beeRange.offset; i < beeRange.offset + beeRange.count; i++) {
-      if (checkCount++ % 1000 == 0) {
-        if (solutionFound.load() || earlyAbort.load()) {
-          return;
-        }
-      }
-
-      std::string hashHex = (CHashWriter(SER_GETHASH, 0)
-                             << deterministicRandString << beeRange.txid << i)
-                                .GetHash()
-                                .GetHex();
-      arith_uint256 beeHash = arith_uint256(hashHex);
-
-      if (beeHash < beeHashTarget) {
-        LOCK(cs_solution_vars);
-
-        solutionFound.store(true);
-        solvingRange = beeRange;
-        solvingBee = i;
-        return;
-      }
-    }
-  }
-}
-
-void CheckBinMinotaur(int threadID, std::vector<CBeeRange> bin,
-                      std::string deterministicRandString,
-                      arith_uint256 beeHashTarget) {
-  int checkCount = 0;
-  for (std::vector<CBeeRange>::const_iterator it = bin.begin(); it != bin.end();
-       it++) {
-    CBeeRange beeRange = *it;
-
-    for (int i = beeRange.offset; i < beeRange.offset + beeRange.count; i++) {
-      if (checkCount++ % 1000 == 0) {
-        if (solutionFound.load() || earlyAbort.load()) {
-          return;
-        }
-      }
-
-      std::stringstream buf;
-      buf << deterministicRandString;
-      buf << beeRange.txid;
-      buf << i;
-      std::string hashString = buf.str();
-
-      uint256 beeHashUint = CBlockHeader::MinotaurHashString(hashString);
-      arith_uint256 beeHash(beeHashUint.ToString());
-
-      if (beeHash < beeHashTarget) {
-        LOCK(cs_solution_vars);
-
-        solutionFound.store(true);
-        solvingRange = beeRange;
-        solvingBee = i;
-
-        return;
-      }
-
-      boost::this_thread::yield();
-    }
-  }
-}
-
 bool BusyBees(const Consensus::Params &consensusParams, int height) {
   bool verbose = LogAcceptCategory(BCLog::HIVE);
 
@@ -684,6 +806,18 @@ bool BusyBees(const Consensus::Params &consensusParams, int height) {
 
   LogPrintf("********************* Hive: Bees at work *********************\n");
 
+  CHiveCheckRoundRecorder recorder;
+  CHiveCheckRound &round = recorder.round;
+  round.nTime = GetTime();
+  round.nHeight = height;
+  round.result = "failed";
+  int64_t nStartTime = GetTimeMicros();
+  {
+    boost::unique_lock<boost::mutex> lock(hiveTipListener.mutex);
+    if (hiveTipListener.tipTime > 0)
+      round.nTipToStartMicros = nStartTime - hiveTipListener.tipTime;
+  }
+
   std::string deterministicRandString = GetDeterministicRandString(pindexPrev);
   if (verbose)
     LogPrintf("BusyBees: deterministicRandString   = %s\n",
@@ -696,22 +830,18 @@ bool BusyBees(const Consensus::Params &consensusParams, int height) {
     LogPrintf("BusyBees: beeHashTarget             = %s\n",
               beeHashTarget.ToString());
 
-  std::vector<CBeeCreationTransactionInfo> potentialBcts =
-      pwallet->GetBCTs(false, false, consensusParams);
-  std::vector<CBeeCreationTransactionInfo> bcts;
+  nStartTime = GetTimeMicros();
+  std::vector<CBeeRange> matureBees =
+      pwallet->GetMatureBeeRanges(pindexPrev, consensusParams);
+  round.nGetBCTsMicros = GetTimeMicros() - nStartTime;
+  nStartTime = GetTimeMicros();
   int totalBees = 0;
-  for (std::vector<CBeeCreationTransactionInfo>::const_iterator it =
-           potentialBcts.begin();
-       it != potentialBcts.end(); it++) {
-    CBeeCreationTransactionInfo bct = *it;
-    if (bct.beeStatus != "mature")
-      continue;
-    bcts.push_back(bct);
-    totalBees += bct.beeCount;
-  }
+  for (const CBeeRange &bct : matureBees)
+    totalBees += bct.count;
 
   if (totalBees == 0) {
     LogPrint(BCLog::HIVE, "BusyBees: No mature bees found\n");
+    round.result = "no bees";
     return false;
   }
 
@@ -724,109 +854,60 @@ bool BusyBees(const Consensus::Params &consensusParams, int height) {
   else if (threadCount == 0)
     threadCount = 1;
 
-  int beesPerBin = ceil(totalBees / (float)threadCount);
+  bool minotaurXEnabled = IsMinotaurXEnabled(pindexPrev, consensusParams);
+  int chunkSize =
+      minotaurXEnabled ? HIVE_CHUNK_SIZE_MINOTAUR : HIVE_CHUNK_SIZE_SHA256;
+  std::vector<CBeeRange> beeChunks;
+  for (const CBeeRange &bct : matureBees) {
+    for (int offset = 0; offset < bct.count; offset += chunkSize) {
+      CBeeRange range = {bct.txid, bct.honeyAddress, bct.communityContrib,
+                         offset, std::min(chunkSize, bct.count - offset)};
+      beeChunks.push_back(range);
+    }
+  }
+
+  round.nBinningMicros = GetTimeMicros() - nStartTime;
+  round.nThreads = threadCount;
+  round.nBees = totalBees;
 
   if (verbose)
     LogPrint(BCLog::HIVE,
-             "BusyBees: Binning %i bees in %i bins (%i bees per bin)\n",
-             totalBees, threadCount, beesPerBin);
-  std::vector<CBeeCreationTransactionInfo>::const_iterator bctIterator =
-      bcts.begin();
-  CBeeCreationTransactionInfo bct = *bctIterator;
-  std::vector<std::vector<CBeeRange>> beeBins;
-  int beeOffset = 0;
-
-  while (bctIterator != bcts.end()) {
-    std::vector<CBeeRange> currentBin;
-
-    int beesInBin = 0;
-    while (bctIterator != bcts.end()) {
-      int spaceLeft = beesPerBin - beesInBin;
-      if (bct.beeCount - beeOffset <= spaceLeft) {
-        CBeeRange range = {bct.txid, bct.honeyAddress, bct.communityContrib,
-                           beeOffset, bct.beeCount - beeOffset};
-        currentBin.push_back(range);
-
-        beesInBin += bct.beeCount - beeOffset;
-        beeOffset = 0;
-
-        do {
-          bctIterator++;
-          if (bctIterator == bcts.end())
-            break;
-          bct = *bctIterator;
-        } while (bct.beeStatus != "mature");
-      } else {
-        CBeeRange range = {bct.txid, bct.honeyAddress, bct.communityContrib,
-                           beeOffset, spaceLeft};
-        currentBin.push_back(range);
-        beeOffset += spaceLeft;
-        break;
-      }
-    }
-    beeBins.push_back(currentBin);
-  }
+             "BusyBees: Queued %i bees in %i chunks for %i threads\n",
+             totalBees, beeChunks.size(), threadCount);
 
   if (verbose)
-    LogPrintf("BusyBees: Running bins\n");
+    LogPrintf("BusyBees: Running chunks\n");
   solutionFound.store(false);
   earlyAbort.store(false);
-  std::vector<std::vector<CBeeRange>>::const_iterator beeBinIterator =
-      beeBins.begin();
-  std::vector<boost::thread> binThreads;
-  int64_t checkTime = GetTimeMillis();
-  int binID = 0;
-  bool minotaurXEnabled = IsMinotaurXEnabled(pindexPrev, consensusParams);
-
-  while (beeBinIterator != beeBins.end()) {
-    std::vector<CBeeRange> beeBin = *beeBinIterator;
-
-    if (verbose) {
-      LogPrintf("BusyBees: Bin #%i\n", binID);
-      std::vector<CBeeRange>::const_iterator beeRangeIterator = beeBin.begin();
-      while (beeRangeIterator != beeBin.end()) {
-        CBeeRange beeRange = *beeRangeIterator;
-        LogPrintf("offset = %i, count = %i, txid = %s\n", beeRange.offset,
-                  beeRange.count, beeRange.txid);
-        beeRangeIterator++;
-      }
-    }
-
-    if (!minotaurXEnabled)
-      binThreads.push_back(boost::thread(
-          CheckBin, binID++, beeBin, deterministicRandString, beeHashTarget));
-    else
-      binThreads.push_back(boost::thread(CheckBinMinotaur, binID++, beeBin,
-                                         deterministicRandString,
-                                         beeHashTarget));
 
-    beeBinIterator++;
-  }
-
-  bool useEarlyAbortThread =
+  bool useEarlyAbort =
       gArgs.GetBoolArg("-hiveearlyout", DEFAULT_HIVE_EARLY_OUT);
-  if (verbose && useEarlyAbortThread)
-    LogPrintf("BusyBees: Will use early-abort thread\n");
-
-  boost::thread earlyAbortThread;
-  if (useEarlyAbortThread)
-    earlyAbortThread = boost::thread(AbortWatchThread, height);
-
-  for (auto &t : binThreads)
-    t.join();
-
-  binThreads.clear();
+  if (verbose && useEarlyAbort)
+    LogPrintf("BusyBees: Will abort early on new tip\n");
+  if (useEarlyAbort) {
+    boost::unique_lock<boost::mutex> lock(hiveTipListener.mutex);
+    hiveTipListener.checkHeight = height;
+    if (hiveTipListener.tipHeight != -1 && hiveTipListener.tipHeight != height)
+      earlyAbort.store(true);
+  }
 
-  checkTime = GetTimeMillis() - checkTime;
+  nStartTime = GetTimeMicros();
+  hiveWorkerPool.Run(threadCount, beeChunks, deterministicRandString,
+                     beeHashTarget, minotaurXEnabled);
+  round.nHashingMicros = GetTimeMicros() - nStartTime;
+  round.nBeesChecked = hiveWorkerPool.BeesChecked();
+  int64_t checkTime = round.nHashingMicros / 1000;
 
-  if (useEarlyAbortThread) {
+  if (useEarlyAbort) {
+    {
+      boost::unique_lock<boost::mutex> lock(hiveTipListener.mutex);
+      hiveTipListener.checkHeight = -1;
+    }
     if (earlyAbort.load()) {
       LogPrintf("BusyBees: Chain state changed (check aborted after %ims)\n",
                 checkTime);
+      round.result = "aborted";
       return false;
-    } else {
-      earlyAbort.store(true);
-      earlyAbortThread.join();
     }
   }
 
@@ -834,6 +915,7 @@ bool BusyBees(const Consensus::Params &consensusParams, int height) {
     LogPrintf("BusyBees: No bee meets hash target (%i bees checked with %i "
               "threads in %ims)\n",
               totalBees, threadCount, checkTime);
+    round.result = "no solution";
     return false;
   }
   LogPrintf("BusyBees: Bee meets hash target (check aborted after %ims). "
@@ -920,6 +1002,7 @@ bool BusyBees(const Consensus::Params &consensusParams, int height) {
     LOCK(cs_main);
     if (pblock->hashPrevBlock != chainActive.Tip()->GetBlockHash()) {
       LogPrintf("BusyBees: Generated block is stale.\n");
+      round.result = "stale";
       return false;
     }
   }
@@ -931,11 +1014,14 @@ bool BusyBees(const Consensus::Params &consensusParams, int height) {
 
   std::shared_ptr<const CBlock> shared_pblock =
       std::make_shared<const CBlock>(*pblock);
+  round.nSubmitMicros = GetTimeMicros() - solvingTime;
   if (!ProcessNewBlock(Params(), shared_pblock, true, nullptr)) {
     LogPrintf("BusyBees: Block wasn't accepted\n");
+    round.result = "rejected";
     return false;
   }
 
   LogPrintf("BusyBees: ** Block mined\n");
+  round.result = "mined";
   return true;
 }
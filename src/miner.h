@@ -31,9 +31,32 @@ static const bool DEFAULT_PRINTPRIORITY = false;
 static const int DEFAULT_HIVE_CHECK_DELAY = 1;
 static const int DEFAULT_HIVE_THREADS = -2;
 static const bool DEFAULT_HIVE_EARLY_OUT = true;
+static const int HIVE_CHUNK_SIZE_SHA256 = 4096;
+static const int HIVE_CHUNK_SIZE_MINOTAUR = 64;
+static const size_t HIVE_STATS_ROUNDS = 144;
 
 static const bool DEFAULT_HIVE_CONTRIB_CF = true;
 
+struct CHiveCheckRound {
+  int64_t nTime;
+  int nHeight;
+  std::string result;
+  int64_t nTipToStartMicros = -1;
+  int64_t nGetBCTsMicros = -1;
+  int64_t nBinningMicros = -1;
+  int64_t nHashingMicros = -1;
+  int64_t nSubmitMicros = -1;
+  int nThreads = 0;
+  int nBees = 0;
+  int64_t nBeesChecked = 0;
+
+  double BeesPerSecondPerThread() const {
+    if (nHashingMicros <= 0 || nThreads <= 0)
+      return 0;
+    return nBeesChecked * 1000000.0 / nHashingMicros / nThreads;
+  }
+};
+
 struct CBlockTemplate {
   CBlock block;
   std::vector<CAmount> vTxFees;
@@ -186,13 +209,6 @@ void BeeKeeper(const CChainParams &chainparams);
 
 bool BusyBees(const Consensus::Params &consensusParams, int height);
 
-void CheckBin(int threadID, std::vector<CBeeRange> bin,
-              std::string deterministicRandString, arith_uint256 beeHashTarget);
-
-void CheckBinMinotaurX(int threadID, std::vector<CBeeRange> bin,
-                       std::string deterministicRandString,
-                       arith_uint256 beeHashTarget);
-
-void AbortWatchThread(int height);
+std::vector<CHiveCheckRound> GetHiveCheckRounds();
 
 #endif
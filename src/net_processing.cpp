@@ -205,6 +205,13 @@ struct CNodeState {
   int nSendCmpctCount;
   int nPongMismatchCount;
 
+  int64_t nLastRialtoTime;
+  int nRialtoCount;
+  int nRialtoQueued;
+  uint64_t nRialtoAccepted;
+  uint64_t nRialtoRejected;
+  uint64_t nRialtoDropped;
+
   CNodeState(CAddress addrIn, std::string addrNameIn)
       : address(addrIn), name(addrNameIn) {
     fCurrentlyConnected = false;
@@ -249,6 +256,12 @@ struct CNodeState {
     nLastNotFoundTime = 0;
     nSendCmpctCount = 0;
     nPongMismatchCount = 0;
+    nLastRialtoTime = 0;
+    nRialtoCount = 0;
+    nRialtoQueued = 0;
+    nRialtoAccepted = 0;
+    nRialtoRejected = 0;
+    nRialtoDropped = 0;
     pindexBestHeaderSent = nullptr;
     pindexBestKnownBlock = nullptr;
     pindexLastCommonBlock = nullptr;
@@ -622,6 +635,10 @@ bool GetNodeStateStats(NodeId nodeid, CNodeStateStats &stats) {
     if (queue.pindex)
       stats.vHeightInFlight.push_back(queue.pindex->nHeight);
   }
+  stats.nRialtoQueued = state->nRialtoQueued;
+  stats.nRialtoAccepted = state->nRialtoAccepted;
+  stats.nRialtoRejected = state->nRialtoRejected;
+  stats.nRialtoDropped = state->nRialtoDropped;
   return true;
 }
 
@@ -806,6 +823,168 @@ static bool BlockRequestAllowed(const CBlockIndex *pindex,
                                       consensusParams) < STALE_RELAY_AGE_LIMIT);
 }
 
+bool RialtoAdmitMessage(int64_t nNow, int64_t &nLastRialtoTime,
+                        int &nRialtoCount, int nRialtoQueued) {
+  if (nNow - nLastRialtoTime > 60) {
+    nLastRialtoTime = nNow;
+    nRialtoCount = 0;
+  }
+  return ++nRialtoCount <= MAX_RIALTO_MESSAGES_PER_MINUTE &&
+         nRialtoQueued < MAX_RIALTO_QUEUED_PER_PEER;
+}
+
+namespace {
+CRialtoVerifyQueue rialtoVerifyQueue;
+} // namespace
+
+void CRialtoVerifyQueue::Start(CConnman *connmanIn, int threadCount) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!fStop)
+    return;
+  connman = connmanIn;
+  fStop = false;
+  for (int i = 0; i < threadCount; i++)
+    threads.emplace_back(&CRialtoVerifyQueue::ThreadVerify, this);
+}
+
+void CRialtoVerifyQueue::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    fStop = true;
+  }
+  cond.notify_all();
+  for (std::thread &thread : threads)
+    thread.join();
+
+  std::lock_guard<std::mutex> lock(mutex);
+  threads.clear();
+  queue.clear();
+  setInFlight.clear();
+}
+
+CRialtoVerifyQueue::PushResult
+CRialtoVerifyQueue::Push(NodeId nodeid, const uint256 &hash,
+                         std::string &message) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (fStop || queue.size() >= nMaxSize)
+      return FULL;
+    if (!setInFlight.insert(hash).second)
+      return DUPLICATE;
+    queue.push_back(CRialtoVerifyItem{nodeid, hash, std::move(message)});
+  }
+  cond.notify_one();
+  return QUEUED;
+}
+
+bool CRialtoVerifyQueue::Pop(std::vector<CRialtoVerifyItem> &items,
+                             size_t nMax) {
+  items.clear();
+  std::unique_lock<std::mutex> lock(mutex);
+  cond.wait(lock, [this] { return fStop || !queue.empty(); });
+  if (fStop)
+    return false;
+  while (!queue.empty() && items.size() < nMax) {
+    items.push_back(std::move(queue.front()));
+    queue.pop_front();
+  }
+  return true;
+}
+
+void CRialtoVerifyQueue::Done(const uint256 &hash) {
+  std::lock_guard<std::mutex> lock(mutex);
+  setInFlight.erase(hash);
+}
+
+void CRialtoVerifyQueue::ThreadVerify() {
+  RenameThread("litecoincash-rialto");
+  std::vector<CRialtoVerifyItem> items;
+  while (Pop(items)) {
+    Verify(items);
+    for (const CRialtoVerifyItem &item : items)
+      Done(item.hash);
+  }
+}
+
+void CRialtoVerifyQueue::Verify(const std::vector<CRialtoVerifyItem> &items) {
+  std::vector<std::string> errs(items.size());
+  std::vector<std::string> layer2Envelopes(items.size());
+  std::vector<uint32_t> timestamps(items.size());
+  std::vector<std::string> powInputs(items.size());
+  std::vector<char> fValid(items.size());
+  for (size_t i = 0; i < items.size(); i++) {
+    try {
+      fValid[i] =
+          RialtoCheckLayer3Envelope(items[i].message, errs[i], powInputs[i],
+                                    &layer2Envelopes[i], &timestamps[i]);
+    } catch (const std::exception &e) {
+      fValid[i] = false;
+      errs[i] = strprintf("Exception '%s' while parsing", e.what());
+    }
+  }
+
+  std::vector<CMinotaurVerifyInput> inputs;
+  std::vector<size_t> inputItems;
+  for (size_t i = 0; i < items.size(); i++) {
+    if (!fValid[i])
+      continue;
+    inputs.push_back({(const unsigned char *)powInputs[i].data(),
+                      powInputs[i].size(), false});
+    inputItems.push_back(i);
+  }
+  std::vector<bool> powValid = MinotaurBatchVerify(
+      inputs,
+      std::vector<arith_uint256>(inputs.size(), RIALTO_MESSAGE_POW_TARGET));
+  for (size_t j = 0; j < inputItems.size(); j++) {
+    if (!powValid[j]) {
+      fValid[inputItems[j]] = false;
+      errs[inputItems[j]] = "Message doesn't meet PoW target.";
+    }
+  }
+
+  {
+    LOCK(cs_main);
+    for (size_t i = 0; i < items.size(); i++) {
+      CNodeState *state = State(items[i].nodeid);
+      if (state) {
+        state->nRialtoQueued--;
+        if (fValid[i])
+          state->nRialtoAccepted++;
+        else
+          state->nRialtoRejected++;
+      }
+      if (!fValid[i]) {
+        LogPrintf("Rialto: Invalid message received from peer=%d; punishing. "
+                  "Error: %s\n",
+                  items[i].nodeid, errs[i]);
+        Misbehaving(items[i].nodeid, 20);
+      }
+    }
+  }
+
+  for (size_t i = 0; i < items.size(); i++) {
+    if (!fValid[i])
+      continue;
+
+    std::string err;
+    bool fDecrypted;
+    try {
+      fDecrypted =
+          RialtoDecryptLayer2Envelope(layer2Envelopes[i], timestamps[i], err);
+    } catch (const std::exception &e) {
+      fDecrypted = false;
+      err = strprintf("Exception '%s' while decrypting", e.what());
+    }
+    if (fDecrypted)
+      LogPrint(BCLog::RIALTO, "Rialto: Message added to receive queue\n");
+    else
+      LogPrint(BCLog::RIALTO, "Rialto: Message decrypt error: %s\n", err);
+
+    CRialtoMessage message(items[i].message);
+    RelayRialtoMessage(message, connman, items[i].nodeid);
+  }
+}
+
 PeerLogicValidation::PeerLogicValidation(CConnman *connmanIn,
                                          CScheduler &scheduler)
     : connman(connmanIn), m_stale_tip_check_time(0) {
@@ -820,8 +999,14 @@ PeerLogicValidation::PeerLogicValidation(CConnman *connmanIn,
       std::bind(&PeerLogicValidation::CheckForStaleTipAndEvictPeers, this,
                 consensusParams),
       EXTRA_PEER_CHECK_INTERVAL * 1000);
+
+  rialtoVerifyQueue.Start(
+      connman, std::max<int>(1, gArgs.GetArg("-rialtoverifythreads",
+                                             DEFAULT_RIALTO_VERIFY_THREADS)));
 }
 
+PeerLogicValidation::~PeerLogicValidation() { rialtoVerifyQueue.Stop(); }
+
 void PeerLogicValidation::BlockConnected(
     const std::shared_ptr<const CBlock> &pblock, const CBlockIndex *pindex,
     const std::vector<CTransactionRef> &vtxConflicted) {
@@ -1010,7 +1195,7 @@ static void RelayTransaction(const CTransaction &tx, CConnman *connman) {
 }
 
 void RelayRialtoMessage(const CRialtoMessage message, CConnman *connman,
-                        CNode *originNode) {
+                        NodeId originNodeId) {
   if ((connman->GetLocalServices() & NODE_RIALTO) != NODE_RIALTO) {
     LogPrint(BCLog::RIALTO,
              "Not relaying Rialto message as we don't support relaying.\n");
@@ -1019,8 +1204,8 @@ void RelayRialtoMessage(const CRialtoMessage message, CConnman *connman,
 
   uint256 hash = message.GetHash();
   CInv inv(MSG_RIALTO, hash);
-  connman->ForEachNode([&inv, originNode](CNode *pnode) {
-    if (pnode != originNode &&
+  connman->ForEachNode([&inv, originNodeId](CNode *pnode) {
+    if (pnode->GetId() != originNodeId &&
         (pnode->nServices & NODE_RIALTO) == NODE_RIALTO) {
       LogPrint(BCLog::RIALTO, "Relaying Rialto message to peer=%d\n",
                pnode->GetId());
@@ -3051,23 +3236,40 @@ bool static ProcessMessage(CNode *pfrom, const std::string &strCommand,
 
     std::string strMsg;
     vRecv >> LIMITED_STRING(strMsg, (RIALTO_L3_MAX_LENGTH * 2));
+    const uint256 hash = CRialtoMessage(strMsg).GetHash();
 
-    std::string err;
-    if (!RialtoParseLayer3Envelope(strMsg, err)) {
-      LogPrintf("Rialto: Invalid message received from peer=%d; punishing. "
-                "Error: %s\n",
-                pfrom->GetId(), err);
-      Misbehaving(pfrom->GetId(), 20);
-      return true;
-    }
+    {
+      LOCK(cs_main);
+      if (mapMessageRelay.count(hash))
+        return true;
 
-    if (RialtoDecryptMessage(strMsg, err))
-      LogPrint(BCLog::RIALTO, "Rialto: Message added to receive queue\n");
-    else
-      LogPrint(BCLog::RIALTO, "Rialto: Message decrypt error: %s\n", err);
+      CNodeState *state = State(pfrom->GetId());
+      if (!RialtoAdmitMessage(GetTime(), state->nLastRialtoTime,
+                              state->nRialtoCount, state->nRialtoQueued)) {
+        state->nRialtoDropped++;
+        LogPrint(BCLog::RIALTO,
+                 "Rialto: Dropping message from peer=%d (%d queued, %d in "
+                 "window)\n",
+                 pfrom->GetId(), state->nRialtoQueued, state->nRialtoCount);
+        return true;
+      }
+      state->nRialtoQueued++;
+    }
 
-    CRialtoMessage message(strMsg);
-    RelayRialtoMessage(message, connman, pfrom);
+    CRialtoVerifyQueue::PushResult result =
+        rialtoVerifyQueue.Push(pfrom->GetId(), hash, strMsg);
+    if (result != CRialtoVerifyQueue::QUEUED) {
+      LOCK(cs_main);
+      CNodeState *state = State(pfrom->GetId());
+      state->nRialtoQueued--;
+      if (result == CRialtoVerifyQueue::FULL) {
+        state->nRialtoDropped++;
+        LogPrint(BCLog::RIALTO,
+                 "Rialto: Verification queue full; dropping message from "
+                 "peer=%d\n",
+                 pfrom->GetId());
+      }
+    }
   }
 
   else {
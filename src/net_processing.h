@@ -12,6 +12,14 @@
 #include <rialto.h>
 #include <validationinterface.h>
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
 static const int64_t ORPHAN_TX_EXPIRE_INTERVAL = 5 * 60;
 static const int64_t ORPHAN_TX_EXPIRE_TIME = 20 * 60;
 
@@ -26,6 +34,60 @@ static constexpr int64_t HEADERS_DOWNLOAD_TIMEOUT_PER_HEADER = 1000;
 static constexpr int64_t MINIMUM_CONNECT_TIME = 30;
 static constexpr int64_t STALE_CHECK_INTERVAL = 2.5 * 60;
 
+static const unsigned int MAX_RIALTO_VERIFY_QUEUE = 1000;
+
+// Messages a verify thread takes at once, so their PoW hashes are checked
+// together on the PoW check queue.
+static const size_t RIALTO_VERIFY_BATCH = 16;
+
+static const int MAX_RIALTO_QUEUED_PER_PEER = 50;
+
+static const int MAX_RIALTO_MESSAGES_PER_MINUTE = 120;
+
+// Counts a message from a peer against its one minute Rialto window and
+// returns whether it may be queued for verification.
+bool RialtoAdmitMessage(int64_t nNow, int64_t &nLastRialtoTime,
+                        int &nRialtoCount, int nRialtoQueued);
+
+struct CRialtoVerifyItem {
+  NodeId nodeid;
+  uint256 hash;
+  std::string message;
+};
+
+// Bounded queue of inbound Rialto messages awaiting verification, with at
+// most one entry per message hash in flight. Start with no threads leaves
+// the items to be taken with Pop. Verify threads take up to
+// RIALTO_VERIFY_BATCH items at a time.
+class CRialtoVerifyQueue {
+public:
+  enum PushResult { QUEUED, DUPLICATE, FULL };
+
+private:
+  std::mutex mutex;
+  std::condition_variable cond;
+  std::deque<CRialtoVerifyItem> queue;
+  std::set<uint256> setInFlight;
+  std::vector<std::thread> threads;
+  CConnman *connman;
+  const size_t nMaxSize;
+  bool fStop;
+
+  void ThreadVerify();
+  void Verify(const std::vector<CRialtoVerifyItem> &items);
+
+public:
+  explicit CRialtoVerifyQueue(size_t nMaxSizeIn = MAX_RIALTO_VERIFY_QUEUE)
+      : connman(nullptr), nMaxSize(nMaxSizeIn), fStop(true) {}
+
+  void Start(CConnman *connmanIn, int threadCount);
+  void Stop();
+  PushResult Push(NodeId nodeid, const uint256 &hash, std::string &message);
+  bool Pop(std::vector<CRialtoVerifyItem> &items,
+           size_t nMax = RIALTO_VERIFY_BATCH);
+  void Done(const uint256 &hash);
+};
+
 class PeerLogicValidation : public CValidationInterface,
                             public NetEventsInterface {
 private:
@@ -33,6 +95,7 @@ private:
 
 public:
   explicit PeerLogicValidation(CConnman *connman, CScheduler &scheduler);
+  ~PeerLogicValidation();
 
   void
   BlockConnected(const std::shared_ptr<const CBlock> &pblock,
@@ -66,12 +129,16 @@ struct CNodeStateStats {
   int nSyncHeight;
   int nCommonHeight;
   std::vector<int> vHeightInFlight;
+  int nRialtoQueued;
+  uint64_t nRialtoAccepted;
+  uint64_t nRialtoRejected;
+  uint64_t nRialtoDropped;
 };
 
 bool GetNodeStateStats(NodeId nodeid, CNodeStateStats &stats);
 
 void Misbehaving(NodeId nodeid, int howmuch);
 void RelayRialtoMessage(const CRialtoMessage message, CConnman *connman,
-                        CNode *originNode = nullptr);
+                        NodeId originNodeId = -1);
 
 #endif
\ No newline at end of file
@@ -9,18 +9,224 @@
 #include <base58.h>
 #include <chain.h>
 #include <core_io.h>
+#include <crypto/minotaurx/minotaur.h>
 #include <hash.h>
 #include <primitives/block.h>
 #include <pubkey.h>
 #include <script/standard.h>
 #include <sync.h>
+#include <txdb.h>
 #include <uint256.h>
 #include <util.h>
 #include <utilstrencodings.h>
 #include <validation.h>
 
+#include <deque>
+#include <map>
+
 BeePopGraphPoint beePopGraph[1024 * 40];
 
+CBeeHasher::CBeeHasher(const std::string &deterministicRandString,
+                       const std::string &txid, bool minotaurXIn,
+                       MinotaurHasher *minotaurHasherIn)
+    : minotaurX(minotaurXIn), minotaurHasher(minotaurHasherIn) {
+  if (!minotaurX) {
+    CDataStream ss(SER_GETHASH, 0);
+    ss << deterministicRandString << txid;
+    prefix.Write((const unsigned char *)ss.data(), ss.size());
+    prefixLen = 0;
+  } else {
+    buf.reserve(deterministicRandString.size() + txid.size() + 10);
+    buf.insert(buf.end(), deterministicRandString.begin(),
+               deterministicRandString.end());
+    buf.insert(buf.end(), txid.begin(), txid.end());
+    prefixLen = buf.size();
+    buf.resize(prefixLen + 10);
+  }
+}
+
+arith_uint256 CBeeHasher::GetHash(uint32_t beeNonce) {
+  if (!minotaurX) {
+    unsigned char nonce[4];
+    WriteLE32(nonce, beeNonce);
+    uint256 hash;
+    prefix.FinalizeDoubleBatch(nonce, sizeof(nonce), 1, hash.begin());
+    return UintToArith256(hash);
+  }
+
+  char digits[10];
+  int numDigits = 0;
+  do {
+    digits[numDigits++] = '0' + beeNonce % 10;
+    beeNonce /= 10;
+  } while (beeNonce);
+
+  char *p = buf.data() + prefixLen;
+  while (numDigits)
+    *p++ = digits[--numDigits];
+
+  if (minotaurHasher)
+    return UintToArith256(
+        minotaurHasher->Hash((const uint8_t *)buf.data(), p - buf.data()));
+  return UintToArith256(
+      CBlockHeader::MinotaurHashArbitrary(buf.data(), p - buf.data()));
+}
+
+void CBeeHasher::GetHashes(uint32_t firstBeeNonce, size_t count,
+                           arith_uint256 *hashes) {
+  if (minotaurX) {
+    for (size_t i = 0; i < count; i++)
+      hashes[i] = GetHash(firstBeeNonce + i);
+    return;
+  }
+
+  unsigned char nonces[4 * BEE_HASH_BATCH];
+  unsigned char batch[32 * BEE_HASH_BATCH];
+  while (count) {
+    size_t n = std::min<size_t>(count, BEE_HASH_BATCH);
+    for (size_t i = 0; i < n; i++)
+      WriteLE32(nonces + 4 * i, firstBeeNonce + i);
+    prefix.FinalizeDoubleBatch(nonces, 4, n, batch);
+    for (size_t i = 0; i < n; i++) {
+      uint256 hash;
+      memcpy(hash.begin(), batch + 32 * i, 32);
+      hashes[i] = UintToArith256(hash);
+    }
+    firstBeeNonce += n;
+    hashes += n;
+    count -= n;
+  }
+}
+
+struct CLWMAWindow {
+  const Consensus::Params *params = nullptr;
+  const CBlockIndex *pindexHead = nullptr;
+  std::deque<int64_t> timestamps;
+  std::deque<int64_t> adjustedTimestamps;
+  std::deque<int64_t> solvetimes;
+  std::deque<arith_uint256> targets;
+  arith_uint256 avgTarget;
+  int64_t sumSolvetimes = 0;
+  int64_t sumWeightedSolvetimes = 0;
+};
+
+struct CHiveWindow {
+  const Consensus::Params *params = nullptr;
+  std::deque<const CBlockIndex *> blocks;
+  arith_uint256 sumTargets;
+};
+
+static CCriticalSection cs_difficultyCache;
+static CLWMAWindow lwmaWindows[NUM_BLOCK_TYPES];
+static CHiveWindow hiveWindow;
+
+void ResetDifficultyCache() {
+  LOCK(cs_difficultyCache);
+  for (CLWMAWindow &window : lwmaWindows)
+    window = CLWMAWindow();
+  hiveWindow = CHiveWindow();
+}
+
+static void AppendLWMABlock(CLWMAWindow &window, const CBlockIndex *pindex,
+                            const int64_t N, const int64_t T,
+                            const int64_t k) {
+  const int64_t previousTimestamp = window.adjustedTimestamps.empty()
+                                        ? pindex->GetBlockTime()
+                                        : window.adjustedTimestamps.back();
+  const int64_t thisTimestamp =
+      std::max(pindex->GetBlockTime(), previousTimestamp + 1);
+  const int64_t solvetime = std::min(6 * T, thisTimestamp - previousTimestamp);
+
+  arith_uint256 target;
+  target.SetCompact(pindex->nBits);
+  target = target / N / k;
+
+  window.timestamps.push_back(pindex->GetBlockTime());
+  window.adjustedTimestamps.push_back(thisTimestamp);
+  window.solvetimes.push_back(solvetime);
+  window.targets.push_back(target);
+  window.sumSolvetimes += solvetime;
+  window.sumWeightedSolvetimes += solvetime * (int64_t)window.solvetimes.size();
+  window.avgTarget += target;
+}
+
+static void SlideLWMAWindow(CLWMAWindow &window, const CBlockIndex *pindexHead,
+                            const int64_t N, const int64_t T,
+                            const int64_t k) {
+  window.sumWeightedSolvetimes -= window.sumSolvetimes;
+  window.sumSolvetimes -= window.solvetimes.front();
+  window.avgTarget -= window.targets.front();
+  window.timestamps.pop_front();
+  window.adjustedTimestamps.pop_front();
+  window.solvetimes.pop_front();
+  window.targets.pop_front();
+
+  for (size_t i = 0; i < window.adjustedTimestamps.size(); i++) {
+    const int64_t previousTimestamp =
+        i ? window.adjustedTimestamps[i - 1] : window.timestamps[0];
+    const int64_t thisTimestamp =
+        std::max(window.timestamps[i], previousTimestamp + 1);
+    const int64_t solvetime =
+        std::min(6 * T, thisTimestamp - previousTimestamp);
+
+    window.sumSolvetimes += solvetime - window.solvetimes[i];
+    window.sumWeightedSolvetimes +=
+        (solvetime - window.solvetimes[i]) * (int64_t)(i + 1);
+    window.solvetimes[i] = solvetime;
+
+    if (thisTimestamp == window.adjustedTimestamps[i])
+      break;
+    window.adjustedTimestamps[i] = thisTimestamp;
+  }
+
+  AppendLWMABlock(window, pindexHead, N, T, k);
+  window.pindexHead = pindexHead;
+}
+
+static bool BuildLWMAWindow(CLWMAWindow &window, const CBlockIndex *pindexHead,
+                            const Consensus::Params &params,
+                            const POW_TYPE powType, const int64_t N,
+                            const int64_t T, const int64_t k,
+                            const bool verbose) {
+  std::vector<const CBlockIndex *> wantedBlocks;
+  const CBlockIndex *pindex = pindexHead;
+  while (true) {
+    if (pindex->nVersion >= 0x20000000) {
+      if (verbose)
+        LogPrintf("* GetNextWorkRequiredLWMA: Allowing %s pow limit "
+                  "(previousTime calc reached forkpoint at height %i)\n",
+                  POW_TYPE_NAMES[powType], pindex->nHeight);
+      return false;
+    }
+
+    if (pindex->IsHiveMined(params) || pindex->GetPoWType() != powType) {
+      assert(pindex->pprev);
+      pindex = pindex->pprev;
+      continue;
+    }
+
+    wantedBlocks.push_back(pindex);
+    if ((int64_t)wantedBlocks.size() == N)
+      break;
+
+    if (pindex->pprevSameKind) {
+      pindex = pindex->pprevSameKind;
+      continue;
+    }
+
+    assert(pindex->pprev);
+    pindex = pindex->pprev;
+  }
+
+  window = CLWMAWindow();
+  window.params = &params;
+  window.pindexHead = pindexHead;
+  for (auto it = wantedBlocks.rbegin(); it != wantedBlocks.rend(); ++it)
+    AppendLWMABlock(window, *it, N, T, k);
+
+  return true;
+}
+
 unsigned int GetNextWorkRequiredLWMA(const CBlockIndex *pindexLast,
                                      const CBlockHeader *pblock,
                                      const Consensus::Params &params,
@@ -50,61 +256,38 @@ unsigned int GetNextWorkRequiredLWMA(const CBlockIndex *pindexLast,
     return powLimit.GetCompact();
   }
 
-  arith_uint256 avgTarget, nextTarget;
-  int64_t thisTimestamp, previousTimestamp;
-  int64_t sumWeightedSolvetimes = 0, j = 0, blocksFound = 0;
-
-  std::vector<const CBlockIndex *> wantedBlocks;
-  const CBlockIndex *blockPreviousTimestamp = pindexLast;
-  while (blocksFound < N) {
-    if (blockPreviousTimestamp->GetBlockHeader().nVersion >= 0x20000000) {
+  const CBlockIndex *pindexHead = pindexLast;
+  while (pindexHead->IsHiveMined(params) ||
+         pindexHead->GetPoWType() != powType) {
+    if (pindexHead->nVersion >= 0x20000000) {
       if (verbose)
         LogPrintf("* GetNextWorkRequiredLWMA: Allowing %s pow limit "
                   "(previousTime calc reached forkpoint at height %i)\n",
-                  POW_TYPE_NAMES[powType], blockPreviousTimestamp->nHeight);
+                  POW_TYPE_NAMES[powType], pindexHead->nHeight);
       return powLimit.GetCompact();
     }
-
-    if (blockPreviousTimestamp->GetBlockHeader().IsHiveMined(params) ||
-        blockPreviousTimestamp->GetBlockHeader().GetPoWType() != powType) {
-      assert(blockPreviousTimestamp->pprev);
-      blockPreviousTimestamp = blockPreviousTimestamp->pprev;
-      continue;
-    }
-
-    wantedBlocks.push_back(blockPreviousTimestamp);
-
-    blocksFound++;
-    if (blocksFound == N)
-
-      break;
-
-    assert(blockPreviousTimestamp->pprev);
-    blockPreviousTimestamp = blockPreviousTimestamp->pprev;
+    assert(pindexHead->pprev);
+    pindexHead = pindexHead->pprev;
   }
-  previousTimestamp = blockPreviousTimestamp->GetBlockTime();
-
-  for (auto it = wantedBlocks.rbegin(); it != wantedBlocks.rend(); ++it) {
-    const CBlockIndex *block = *it;
-
-    thisTimestamp = (block->GetBlockTime() > previousTimestamp)
-                        ? block->GetBlockTime()
-                        : previousTimestamp + 1;
-
-    int64_t solvetime = std::min(6 * T, thisTimestamp - previousTimestamp);
-
-    previousTimestamp = thisTimestamp;
 
-    j++;
-    sumWeightedSolvetimes += solvetime * j;
-
-    arith_uint256 target;
-    target.SetCompact(block->nBits);
-    avgTarget += target / N / k;
+  arith_uint256 nextTarget;
+  {
+    LOCK(cs_difficultyCache);
+    CLWMAWindow &window = lwmaWindows[powType];
+    if (window.params != &params || window.pindexHead != pindexHead) {
+      if (window.params == &params && window.pindexHead &&
+          pindexHead->pprevSameKind == window.pindexHead &&
+          pindexHead->nVersion < 0x20000000) {
+        SlideLWMAWindow(window, pindexHead, N, T, k);
+      } else if (!BuildLWMAWindow(window, pindexHead, params, powType, N, T,
+                                  k, verbose)) {
+        window = CLWMAWindow();
+        return powLimit.GetCompact();
+      }
+    }
+    nextTarget = window.avgTarget * window.sumWeightedSolvetimes;
   }
 
-  nextTarget = avgTarget * sumWeightedSolvetimes;
-
   if (nextTarget > powLimit) {
     if (verbose)
       LogPrintf("* GetNextWorkRequiredLWMA: Allowing %s pow limit (target too "
@@ -128,7 +311,7 @@ unsigned int DarkGravityWave(const CBlockIndex *pindexLast,
     return bnPowLimit.GetCompact();
 
   if (IsHive11Enabled(pindexLast, params)) {
-    while (pindexLast->GetBlockHeader().IsHiveMined(params)) {
+    while (pindexLast->IsHiveMined(params)) {
       assert(pindexLast->pprev);
 
       pindexLast = pindexLast->pprev;
@@ -143,7 +326,7 @@ unsigned int DarkGravityWave(const CBlockIndex *pindexLast,
 
   for (unsigned int nCountBlocks = 1; nCountBlocks <= nPastBlocks;
        nCountBlocks++) {
-    while (pindex->GetBlockHeader().IsHiveMined(params)) {
+    while (pindex->IsHiveMined(params)) {
       assert(pindex->pprev);
 
       pindex = pindex->pprev;
@@ -270,20 +453,45 @@ unsigned int CalculateNextWorkRequired(const CBlockIndex *pindexLast,
   return bnNew.GetCompact();
 }
 
-bool CheckProofOfWork(uint256 hash, unsigned int nBits,
-                      const Consensus::Params &params) {
+arith_uint256 GetPoWLimit(const Consensus::Params &params) {
+  arith_uint256 powLimit = 0;
+  for (int i = 0; i < NUM_BLOCK_TYPES; i++)
+    if (UintToArith256(params.powTypeLimits[i]) > powLimit)
+      powLimit = UintToArith256(params.powTypeLimits[i]);
+  return powLimit;
+}
+
+// The limit for the header's own PoW type, never looser than the limit
+// CheckProofOfWork applies to every type.
+arith_uint256 GetPoWLimit(const CBlockHeader &header,
+                          const Consensus::Params &params) {
+  arith_uint256 powLimit = GetPoWLimit(params);
+  arith_uint256 typeLimit;
+  if (header.IsScryptPoW())
+    typeLimit = UintToArith256(params.powLimit);
+  else if (header.nVersion >= 0x20000000)
+    typeLimit = UintToArith256(params.powTypeLimits[POW_TYPE_SHA256]);
+  else if (header.GetPoWType() < NUM_BLOCK_TYPES)
+    typeLimit = UintToArith256(params.powTypeLimits[header.GetPoWType()]);
+  else
+    return 0;
+  return typeLimit < powLimit ? typeLimit : powLimit;
+}
+
+bool DecodePoWTarget(unsigned int nBits, const arith_uint256 &powLimit,
+                     arith_uint256 &bnTarget) {
   bool fNegative;
   bool fOverflow;
-  arith_uint256 bnTarget;
 
   bnTarget.SetCompact(nBits, &fNegative, &fOverflow);
 
-  arith_uint256 powLimit = 0;
-  for (int i = 0; i < NUM_BLOCK_TYPES; i++)
-    if (UintToArith256(params.powTypeLimits[i]) > powLimit)
-      powLimit = UintToArith256(params.powTypeLimits[i]);
+  return !fNegative && bnTarget != 0 && !fOverflow && bnTarget <= powLimit;
+}
 
-  if (fNegative || bnTarget == 0 || fOverflow || bnTarget > powLimit)
+bool CheckProofOfWork(uint256 hash, unsigned int nBits,
+                      const Consensus::Params &params) {
+  arith_uint256 bnTarget;
+  if (!DecodePoWTarget(nBits, GetPoWLimit(params), bnTarget))
     return false;
 
   if (UintToArith256(hash) > bnTarget)
@@ -292,6 +500,60 @@ bool CheckProofOfWork(uint256 hash, unsigned int nBits,
   return true;
 }
 
+static const CBlockIndex *LastHiveBlock(const CBlockIndex *pindex,
+                                        const Consensus::Params &params) {
+  while (pindex && !pindex->IsHiveMined(params))
+    pindex = pindex->pprev;
+  return pindex;
+}
+
+static const CBlockIndex *PrevHiveBlock(const CBlockIndex *pindex,
+                                        const Consensus::Params &params) {
+  if (pindex->pprevSameKind)
+    return pindex->pprevSameKind;
+  return LastHiveBlock(pindex->pprev, params);
+}
+
+static bool GetHiveWindow(const CBlockIndex *pindexLast,
+                          const Consensus::Params &params,
+                          arith_uint256 &sumTargets,
+                          const CBlockIndex *&pindexOldest) {
+  const CBlockIndex *pindexHive = LastHiveBlock(pindexLast, params);
+  if (!pindexHive)
+    return false;
+
+  LOCK(cs_difficultyCache);
+  CHiveWindow &window = hiveWindow;
+  if (window.params != &params || window.blocks.empty() ||
+      window.blocks.back() != pindexHive) {
+    if (window.params == &params && !window.blocks.empty() &&
+        window.blocks.back() == PrevHiveBlock(pindexHive, params)) {
+      window.sumTargets -=
+          arith_uint256().SetCompact(window.blocks.front()->nBits);
+      window.blocks.pop_front();
+      window.sumTargets += arith_uint256().SetCompact(pindexHive->nBits);
+      window.blocks.push_back(pindexHive);
+    } else {
+      window = CHiveWindow();
+      window.params = &params;
+      for (const CBlockIndex *pindex = pindexHive;
+           pindex && (int)window.blocks.size() < params.hiveDifficultyWindow;
+           pindex = PrevHiveBlock(pindex, params)) {
+        window.sumTargets += arith_uint256().SetCompact(pindex->nBits);
+        window.blocks.push_front(pindex);
+      }
+      if ((int)window.blocks.size() < params.hiveDifficultyWindow) {
+        window = CHiveWindow();
+        return false;
+      }
+    }
+  }
+
+  sumTargets = window.sumTargets;
+  pindexOldest = window.blocks.front();
+  return true;
+}
+
 unsigned int GetNextHive11WorkRequired(const CBlockIndex *pindexLast,
                                        const Consensus::Params &params) {
   const arith_uint256 bnPowLimit = UintToArith256(params.powLimitHive);
@@ -300,16 +562,34 @@ unsigned int GetNextHive11WorkRequired(const CBlockIndex *pindexLast,
   int hiveBlockCount = 0;
   int totalBlockCount = 0;
 
-  while (hiveBlockCount < params.hiveDifficultyWindow && pindexLast->pprev &&
-         pindexLast->nHeight >= params.minHiveCheckBlock) {
-    if (pindexLast->GetBlockHeader().IsHiveMined(params)) {
-      beeHashTarget += arith_uint256().SetCompact(pindexLast->nBits);
-      hiveBlockCount++;
+  const int nMinHeight = std::max(params.minHiveCheckBlock, 1);
+  const CBlockIndex *pindex = pindexLast;
+  const CBlockIndex *pindexOldest = nullptr;
+  arith_uint256 windowTargets;
+  const CBlockIndex *pindexWindowOldest = nullptr;
+  if (GetHiveWindow(pindexLast, params, windowTargets, pindexWindowOldest) &&
+      pindexWindowOldest->nHeight >= nMinHeight) {
+    beeHashTarget = windowTargets;
+    hiveBlockCount = params.hiveDifficultyWindow;
+    pindexOldest = pindexWindowOldest;
+  }
+  while (hiveBlockCount < params.hiveDifficultyWindow && pindex &&
+         pindex->nHeight >= nMinHeight) {
+    if (!pindex->IsHiveMined(params)) {
+      pindex = pindex->pprev;
+      continue;
     }
-    totalBlockCount++;
-    pindexLast = pindexLast->pprev;
+    beeHashTarget += arith_uint256().SetCompact(pindex->nBits);
+    hiveBlockCount++;
+    pindexOldest = pindex;
+    pindex = pindex->pprevSameKind ? pindex->pprevSameKind : pindex->pprev;
   }
 
+  if (hiveBlockCount == params.hiveDifficultyWindow)
+    totalBlockCount = pindexLast->nHeight - pindexOldest->nHeight + 1;
+  else
+    totalBlockCount = std::max(pindexLast->nHeight - nMinHeight + 1, 0);
+
   if (hiveBlockCount == 0) {
     LogPrintf("GetNextHive11WorkRequired: No previous hive blocks found.\n");
     return bnPowLimit.GetCompact();
@@ -335,14 +615,27 @@ unsigned int GetNextHive12WorkRequired(const CBlockIndex *pindexLast,
   int hiveBlockCount = 0;
   int totalBlockCount = 0;
 
-  while (hiveBlockCount < params.hiveDifficultyWindow && pindexLast->pprev &&
-         IsMinotaurXEnabled(pindexLast, params)) {
-    if (pindexLast->GetBlockHeader().IsHiveMined(params)) {
-      beeHashTarget += arith_uint256().SetCompact(pindexLast->nBits);
-      hiveBlockCount++;
+  const CBlockIndex *pindex = pindexLast;
+  const CBlockIndex *pindexOldest = nullptr;
+  arith_uint256 windowTargets;
+  const CBlockIndex *pindexWindowOldest = nullptr;
+  if (GetHiveWindow(pindexLast, params, windowTargets, pindexWindowOldest) &&
+      pindexWindowOldest->pprev &&
+      IsMinotaurXEnabled(pindexWindowOldest, params)) {
+    beeHashTarget = windowTargets;
+    hiveBlockCount = params.hiveDifficultyWindow;
+    pindexOldest = pindexWindowOldest;
+  }
+  while (hiveBlockCount < params.hiveDifficultyWindow && pindex &&
+         pindex->pprev && IsMinotaurXEnabled(pindex, params)) {
+    if (!pindex->IsHiveMined(params)) {
+      pindex = pindex->pprev;
+      continue;
     }
-    totalBlockCount++;
-    pindexLast = pindexLast->pprev;
+    beeHashTarget += arith_uint256().SetCompact(pindex->nBits);
+    hiveBlockCount++;
+    pindexOldest = pindex;
+    pindex = pindex->pprevSameKind ? pindex->pprevSameKind : pindex->pprev;
   }
 
   if (hiveBlockCount < params.hiveDifficultyWindow) {
@@ -350,6 +643,8 @@ unsigned int GetNextHive12WorkRequired(const CBlockIndex *pindexLast,
     return bnPowLimit.GetCompact();
   }
 
+  totalBlockCount = pindexLast->nHeight - pindexOldest->nHeight + 1;
+
   beeHashTarget /= hiveBlockCount;
 
   int targetTotalBlockCount = hiveBlockCount * params.hiveBlockSpacingTarget;
@@ -375,7 +670,6 @@ unsigned int GetNextHiveWorkRequired(const CBlockIndex *pindexLast,
   arith_uint256 beeHashTarget;
 
   int numPowBlocks = 0;
-  CBlockHeader block;
   while (true) {
     if (!pindexLast->pprev || pindexLast->nHeight < params.minHiveCheckBlock) {
       LogPrintf(
@@ -384,9 +678,8 @@ unsigned int GetNextHiveWorkRequired(const CBlockIndex *pindexLast,
       return bnPowLimit.GetCompact();
     }
 
-    block = pindexLast->GetBlockHeader();
-    if (block.IsHiveMined(params)) {
-      beeHashTarget.SetCompact(block.nBits);
+    if (pindexLast->IsHiveMined(params)) {
+      beeHashTarget.SetCompact(pindexLast->nBits);
       break;
     }
 
@@ -409,6 +702,70 @@ unsigned int GetNextHiveWorkRequired(const CBlockIndex *pindexLast,
   return beeHashTarget.GetCompact();
 }
 
+struct CBeePopBlock {
+  const CBlockIndex *pindex;
+  int bees;
+  int bcts;
+};
+
+static CCriticalSection cs_beePopIndex;
+static std::map<int, CBeePopBlock> mapBeePopIndex;
+
+static CBeePopBlock CountBlockBees(const CBlock &block,
+                                   const CBlockIndex *pindex,
+                                   const Consensus::Params &consensusParams) {
+  CBeePopBlock entry = {pindex, 0, 0};
+  if (block.IsHiveMined(consensusParams))
+    return entry;
+
+  CScript scriptPubKeyBCF = GetScriptForDestination(
+      DecodeDestination(consensusParams.beeCreationAddress));
+  CScript scriptPubKeyCF = GetScriptForDestination(
+      DecodeDestination(consensusParams.hiveCommunityAddress));
+  CAmount beeCost = GetBeeCost(pindex->nHeight, consensusParams);
+
+  for (const auto &tx : block.vtx) {
+    CAmount beeFeePaid;
+    if (tx->IsBCT(consensusParams, scriptPubKeyBCF, &beeFeePaid)) {
+      if (tx->vout.size() > 1 && tx->vout[1].scriptPubKey == scriptPubKeyCF) {
+        CAmount donationAmount = tx->vout[1].nValue;
+        CAmount expectedDonationAmount =
+            (beeFeePaid + donationAmount) /
+            consensusParams.communityContribFactor;
+
+        if (IsMinotaurXEnabled(pindex, consensusParams))
+          expectedDonationAmount += expectedDonationAmount >> 1;
+        if (donationAmount != expectedDonationAmount)
+          continue;
+        beeFeePaid += donationAmount;
+      }
+      entry.bees += beeFeePaid / beeCost;
+      entry.bcts++;
+    }
+  }
+  return entry;
+}
+
+void AddBlockToBeePopIndex(const CBlock &block, const CBlockIndex *pindex,
+                           const Consensus::Params &consensusParams) {
+  CBeePopBlock entry = CountBlockBees(block, pindex, consensusParams);
+  int totalBeeLifespan =
+      consensusParams.beeLifespanBlocks + consensusParams.beeGestationBlocks;
+
+  LOCK(cs_beePopIndex);
+  mapBeePopIndex[pindex->nHeight] = entry;
+  mapBeePopIndex.erase(
+      mapBeePopIndex.begin(),
+      mapBeePopIndex.lower_bound(pindex->nHeight - totalBeeLifespan));
+}
+
+void RemoveBlockFromBeePopIndex(const CBlockIndex *pindex) {
+  LOCK(cs_beePopIndex);
+  auto it = mapBeePopIndex.find(pindex->nHeight);
+  if (it != mapBeePopIndex.end() && it->second.pindex == pindex)
+    mapBeePopIndex.erase(it);
+}
+
 bool GetNetworkHiveInfo(int &immatureBees, int &immatureBCTs, int &matureBees,
                         int &matureBCTs, CAmount &potentialLifespanRewards,
                         const Consensus::Params &consensusParams,
@@ -445,82 +802,88 @@ bool GetNetworkHiveInfo(int &immatureBees, int &immatureBCTs, int &matureBees,
 
     return false;
 
-  CBlock block;
-  CScript scriptPubKeyBCF = GetScriptForDestination(
-      DecodeDestination(consensusParams.beeCreationAddress));
-  CScript scriptPubKeyCF = GetScriptForDestination(
-      DecodeDestination(consensusParams.hiveCommunityAddress));
+  std::vector<int> immatureDelta, matureDelta;
+  if (recalcGraph) {
+    immatureDelta.assign(totalBeeLifespan + 1, 0);
+    matureDelta.assign(totalBeeLifespan + 1, 0);
+  }
+  auto addGraphRange = [&](std::vector<int> &delta, int from, int to,
+                           int count) {
+    from = std::max(from - tipHeight, 1);
+    to = std::min(to - tipHeight, totalBeeLifespan);
+    if (from < to) {
+      delta[from] += count;
+      delta[to] -= count;
+    }
+  };
 
+  CBlock block;
   for (int i = 0; i < totalBeeLifespan; i++) {
-    if (fHavePruned && !(pindexPrev->nStatus & BLOCK_HAVE_DATA) &&
-        pindexPrev->nTx > 0) {
-      LogPrintf("! GetNetworkHiveInfo: Warn: Block not available (pruned "
-                "data); can't calculate network bee count.");
-      return false;
+    CBeePopBlock entry;
+    bool fCached;
+    {
+      LOCK(cs_beePopIndex);
+      auto it = mapBeePopIndex.find(pindexPrev->nHeight);
+      fCached = it != mapBeePopIndex.end() && it->second.pindex == pindexPrev;
+      if (fCached)
+        entry = it->second;
     }
 
-    if (!pindexPrev->GetBlockHeader().IsHiveMined(consensusParams)) {
-      if (!ReadBlockFromDisk(block, pindexPrev, consensusParams)) {
-        LogPrintf("! GetNetworkHiveInfo: Warn: Block not available (not found "
-                  "on disk); can't calculate network bee count.");
+    if (!fCached) {
+      if (fHavePruned && !(pindexPrev->nStatus & BLOCK_HAVE_DATA) &&
+          pindexPrev->nTx > 0) {
+        LogPrintf("! GetNetworkHiveInfo: Warn: Block not available (pruned "
+                  "data); can't calculate network bee count.");
         return false;
       }
-      int blockHeight = pindexPrev->nHeight;
-      CAmount beeCost = GetBeeCost(blockHeight, consensusParams);
-      if (block.vtx.size() > 0) {
-        for (const auto &tx : block.vtx) {
-          CAmount beeFeePaid;
-          if (tx->IsBCT(consensusParams, scriptPubKeyBCF, &beeFeePaid)) {
-            if (tx->vout.size() > 1 &&
-                tx->vout[1].scriptPubKey == scriptPubKeyCF) {
-              CAmount donationAmount = tx->vout[1].nValue;
-              CAmount expectedDonationAmount =
-                  (beeFeePaid + donationAmount) /
-                  consensusParams.communityContribFactor;
-
-              if (IsMinotaurXEnabled(pindexPrev, consensusParams))
-                expectedDonationAmount += expectedDonationAmount >> 1;
-              if (donationAmount != expectedDonationAmount)
-                continue;
-              beeFeePaid += donationAmount;
-            }
-            int beeCount = beeFeePaid / beeCost;
-            if (i < consensusParams.beeGestationBlocks) {
-              immatureBees += beeCount;
-              immatureBCTs++;
-            } else {
-              matureBees += beeCount;
-              matureBCTs++;
-            }
-
-            if (recalcGraph) {
-              int beeBornBlock = blockHeight;
-              int beeMaturesBlock =
-                  beeBornBlock + consensusParams.beeGestationBlocks;
-              int beeDiesBlock =
-                  beeMaturesBlock + consensusParams.beeLifespanBlocks;
-              for (int j = beeBornBlock; j < beeDiesBlock; j++) {
-                int graphPos = j - tipHeight;
-                if (graphPos > 0 && graphPos < totalBeeLifespan) {
-                  if (j < beeMaturesBlock)
-                    beePopGraph[graphPos].immaturePop += beeCount;
-                  else
-                    beePopGraph[graphPos].maturePop += beeCount;
-                }
-              }
-            }
-          }
+
+      if (!pindexPrev->IsHiveMined(consensusParams)) {
+        if (!ReadBlockFromDisk(block, pindexPrev, consensusParams)) {
+          LogPrintf("! GetNetworkHiveInfo: Warn: Block not available (not "
+                    "found on disk); can't calculate network bee count.");
+          return false;
         }
+        entry = CountBlockBees(block, pindexPrev, consensusParams);
+      } else {
+        entry = {pindexPrev, 0, 0};
       }
+
+      LOCK(cs_beePopIndex);
+      mapBeePopIndex[pindexPrev->nHeight] = entry;
     }
 
-    if (!pindexPrev->pprev)
+    if (i < consensusParams.beeGestationBlocks) {
+      immatureBees += entry.bees;
+      immatureBCTs += entry.bcts;
+    } else {
+      matureBees += entry.bees;
+      matureBCTs += entry.bcts;
+    }
+
+    if (recalcGraph && entry.bees > 0) {
+      int beeBornBlock = pindexPrev->nHeight;
+      int beeMaturesBlock = beeBornBlock + consensusParams.beeGestationBlocks;
+      int beeDiesBlock = beeMaturesBlock + consensusParams.beeLifespanBlocks;
+      addGraphRange(immatureDelta, beeBornBlock, beeMaturesBlock, entry.bees);
+      addGraphRange(matureDelta, beeMaturesBlock, beeDiesBlock, entry.bees);
+    }
 
-      return true;
+    if (!pindexPrev->pprev)
+      break;
 
     pindexPrev = pindexPrev->pprev;
   }
 
+  if (recalcGraph) {
+    int immaturePop = 0, maturePop = 0;
+    for (int i = 0; i < totalBeeLifespan; i++) {
+      immaturePop += immatureDelta[i];
+      maturePop += matureDelta[i];
+      beePopGraph[i].immaturePop = immaturePop;
+      beePopGraph[i].maturePop = maturePop;
+    }
+  }
+
   return true;
 }
 
@@ -555,7 +918,7 @@ bool CheckHiveProof(const CBlock *pblock,
   if (IsHive11Enabled(pindexPrev, consensusParams)) {
     int hiveBlocksAtTip = 0;
     CBlockIndex *pindexTemp = pindexPrev;
-    while (pindexTemp->GetBlockHeader().IsHiveMined(consensusParams)) {
+    while (pindexTemp->IsHiveMined(consensusParams)) {
       assert(pindexTemp->pprev);
       pindexTemp = pindexTemp->pprev;
       hiveBlocksAtTip++;
@@ -565,7 +928,7 @@ bool CheckHiveProof(const CBlock *pblock,
       return false;
     }
   } else {
-    if (pindexPrev->GetBlockHeader().IsHiveMined(consensusParams)) {
+    if (pindexPrev->IsHiveMined(consensusParams)) {
       LogPrint(BCLog::HIVE,
                "CheckHiveProof: Hive block must follow a POW block.\n");
       return false;
@@ -637,30 +1000,15 @@ bool CheckHiveProof(const CBlock *pblock,
     LogPrintf("CheckHiveProof: beeHashTarget       = %s\n",
               beeHashTarget.ToString());
 
-  if (!IsMinotaurXEnabled(pindexPrev, consensusParams)) {
-    std::string hashHex = (CHashWriter(SER_GETHASH, 0)
-                           << deterministicRandString << txidStr << beeNonce)
-                              .GetHash()
-                              .GetHex();
-    arith_uint256 beeHash = arith_uint256(hashHex);
-    if (verbose)
-      LogPrintf("CheckHiveProof: beeHash             = %s\n", beeHash.GetHex());
-    if (beeHash >= beeHashTarget) {
-      LogPrintf("CheckHiveProof: Bee does not meet hash target!\n");
-      return false;
-    }
-  } else {
-    arith_uint256 beeHash(CBlockHeader::MinotaurHashArbitrary(
-                              std::string(deterministicRandString + txidStr +
-                                          std::to_string(beeNonce))
-                                  .c_str())
-                              .ToString());
-    if (verbose)
-      LogPrintf("CheckHive12Proof: beeHash           = %s\n", beeHash.GetHex());
-    if (beeHash >= beeHashTarget) {
-      LogPrintf("CheckHive12Proof: Bee does not meet hash target!\n");
-      return false;
-    }
+  arith_uint256 beeHash =
+      CBeeHasher(deterministicRandString, txidStr,
+                 IsMinotaurXEnabled(pindexPrev, consensusParams))
+          .GetHash(beeNonce);
+  if (verbose)
+    LogPrintf("CheckHiveProof: beeHash             = %s\n", beeHash.GetHex());
+  if (beeHash >= beeHashTarget) {
+    LogPrintf("CheckHiveProof: Bee does not meet hash target!\n");
+    return false;
   }
 
   std::vector<unsigned char> messageSig(
@@ -716,6 +1064,8 @@ bool CheckHiveProof(const CBlock *pblock,
     Coin coin;
     CTransactionRef bct = nullptr;
     CBlockIndex foundAt;
+    CDiskBCTInfo bctInfo;
+    bool fIndexedBCT = false;
 
     if (pcoinsTip && pcoinsTip->GetCoin(outBeeCreation, coin)) {
       if (verbose)
@@ -726,6 +1076,15 @@ bool CheckHiveProof(const CBlock *pblock,
       bctWasMinotaurXEnabled =
           IsMinotaurXEnabled(chainActive[bctFoundHeight], consensusParams);
 
+    } else if (GetIndexedBCT(uint256S(txidStr), pindexPrev, bctInfo)) {
+      if (verbose)
+        LogPrintf("CheckHiveProof: Using BCT index for outBeeCreation\n");
+      fIndexedBCT = true;
+      bctValue = bctInfo.beeFeeOut.nValue;
+      bctScriptPubKey = bctInfo.beeFeeOut.scriptPubKey;
+      bctFoundHeight = bctInfo.nHeight;
+      bctWasMinotaurXEnabled = IsMinotaurXEnabled(
+          pindexPrev->GetAncestor(bctFoundHeight), consensusParams);
     } else {
       if (verbose)
         LogPrintf(
@@ -757,6 +1116,16 @@ bool CheckHiveProof(const CBlock *pblock,
             return false;
           }
           donationAmount = coin.out.nValue;
+        } else if (fIndexedBCT ||
+                   GetIndexedBCT(uint256S(txidStr), pindexPrev, bctInfo)) {
+          if (verbose)
+            LogPrintf("CheckHiveProof: Using BCT index for outCommFund\n");
+          if (bctInfo.communityOut.scriptPubKey != scriptPubKeyCF) {
+            LogPrintf("CheckHiveProof: Community contrib was indicated but not "
+                      "found\n");
+            return false;
+          }
+          donationAmount = bctInfo.communityOut.nValue;
         } else {
           if (verbose)
             LogPrintf(
@@ -6,21 +6,53 @@
 #ifndef BITCOIN_POW_H
 #define BITCOIN_POW_H
 
+#include <arith_uint256.h>
 #include <consensus/params.h>
+#include <hash.h>
 #include <primitives/block.h>
 
 #include <stdint.h>
+#include <string>
+#include <vector>
 
 class CBlockHeader;
 class CBlockIndex;
 class uint256;
 class CBlock;
+class MinotaurHasher;
 
 struct BeePopGraphPoint {
   int immaturePop;
   int maturePop;
 };
 
+// Number of bees hashed per CBeeHasher::GetHashes call in the hive checks.
+static const int BEE_HASH_BATCH = 8;
+
+// Computes bee hashes for every bee of a single BCT. The constant
+// deterministicRandString + txid prefix is absorbed once, so each bee costs
+// only the hashing itself, with no allocation or hex round-tripping.
+// GetHashes hashes runs of consecutive bees through the multi-way SHA256
+// transforms where available. MinotaurX-era bees are hashed with the given
+// engine, so a hive worker can keep one for its whole check round; without
+// one, the calling thread's engine is used.
+class CBeeHasher {
+private:
+  bool minotaurX;
+  CSHA256 prefix;
+  std::vector<char> buf;
+  size_t prefixLen;
+  MinotaurHasher *minotaurHasher;
+
+public:
+  CBeeHasher(const std::string &deterministicRandString,
+             const std::string &txid, bool minotaurXIn,
+             MinotaurHasher *minotaurHasherIn = nullptr);
+
+  arith_uint256 GetHash(uint32_t beeNonce);
+  void GetHashes(uint32_t firstBeeNonce, size_t count, arith_uint256 *hashes);
+};
+
 unsigned int GetNextWorkRequired(const CBlockIndex *pindexLast,
                                  const CBlockHeader *pblock,
                                  const Consensus::Params &);
@@ -28,6 +60,7 @@ unsigned int CalculateNextWorkRequired(const CBlockIndex *pindexLast,
                                        int64_t nFirstBlockTime,
                                        const Consensus::Params &);
 unsigned int DarkGravityWave(const CBlockIndex *pindexLast,
+                             const CBlockHeader *pblock,
                              const Consensus::Params &params);
 
 unsigned int GetNextWorkRequiredLTC(const CBlockIndex *pindexLast,
@@ -42,13 +75,26 @@ unsigned int GetNextWorkRequiredLWMA(const CBlockIndex *pindexLast,
                                      const Consensus::Params &params,
                                      const POW_TYPE powType);
 
+void ResetDifficultyCache();
+
 bool CheckHiveProof(const CBlock *pblock, const Consensus::Params &params);
 
+void AddBlockToBeePopIndex(const CBlock &block, const CBlockIndex *pindex,
+                           const Consensus::Params &consensusParams);
+
+void RemoveBlockFromBeePopIndex(const CBlockIndex *pindex);
+
 bool GetNetworkHiveInfo(int &immatureBees, int &immatureBCTs, int &matureBees,
                         int &matureBCTs, CAmount &potentialLifespanRewards,
                         const Consensus::Params &consensusParams,
                         bool recalcGraph = false);
 
+arith_uint256 GetPoWLimit(const Consensus::Params &params);
+arith_uint256 GetPoWLimit(const CBlockHeader &header,
+                          const Consensus::Params &params);
+bool DecodePoWTarget(unsigned int nBits, const arith_uint256 &powLimit,
+                     arith_uint256 &bnTarget);
+
 bool CheckProofOfWork(uint256 hash, unsigned int nBits,
                       const Consensus::Params &);
 
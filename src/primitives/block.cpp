@@ -18,18 +18,122 @@
 
 #include <util.h>
 
+#include <unordered_map>
+
+static const size_t POW_HASH_CACHE_SIZE = 20000;
+
+namespace {
+struct PoWHashCacheHasher {
+  size_t operator()(const uint256 &hash) const { return hash.GetCheapHash(); }
+};
+
+class CPoWHashCache {
+private:
+  CCriticalSection cs;
+  std::unordered_map<uint256, uint256, PoWHashCacheHasher> current;
+  std::unordered_map<uint256, uint256, PoWHashCacheHasher> previous;
+
+  void InsertLocked(const uint256 &hash, const uint256 &powHash) {
+    if (current.size() >= POW_HASH_CACHE_SIZE) {
+      previous.swap(current);
+      current.clear();
+    }
+    current[hash] = powHash;
+  }
+
+public:
+  bool Get(const uint256 &hash, uint256 &powHash) {
+    LOCK(cs);
+    auto it = current.find(hash);
+    if (it != current.end()) {
+      powHash = it->second;
+      return true;
+    }
+    it = previous.find(hash);
+    if (it == previous.end())
+      return false;
+    powHash = it->second;
+    InsertLocked(hash, powHash);
+    return true;
+  }
+
+  void Put(const uint256 &hash, const uint256 &powHash) {
+    LOCK(cs);
+    InsertLocked(hash, powHash);
+  }
+};
+
+CPoWHashCache &PoWHashCache() {
+  static CPoWHashCache cache;
+  return cache;
+}
+} // namespace
+
 uint256 CBlockHeader::GetHash() const { return SerializeHash(*this); }
 
 uint256 CBlockHeader::MinotaurHashArbitrary(const char *data) {
   return Minotaur(data, data + strlen(data), false);
 }
 
+uint256 CBlockHeader::MinotaurHashArbitrary(const char *data, size_t len) {
+  return MinotaurHasher::ForThisThread().Hash((const uint8_t *)data, len);
+}
+
 uint256 CBlockHeader::MinotaurHashString(std::string data) {
   return Minotaur(data.begin(), data.end(), false);
 }
 
-uint256 CBlockHeader::GetPoWHash() const {
-  if (nTime > Params().GetConsensus().powForkTime) {
+bool CBlockHeader::IsScryptPoW() const {
+  return nTime <= Params().GetConsensus().powForkTime;
+}
+
+void CBlockHeader::GetScryptPoWHashes(const CBlockHeader *headers, size_t count,
+                                      uint256 *hashes) {
+  std::vector<uint256> blockHashes;
+  std::vector<size_t> missing;
+  std::vector<char> input;
+  blockHashes.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    blockHashes.push_back(headers[i].GetHash());
+    if (PoWHashCache().Get(blockHashes[i], hashes[i]))
+      continue;
+    missing.push_back(i);
+    input.insert(input.end(), BEGIN(headers[i].nVersion),
+                 END(headers[i].nNonce));
+  }
+  if (missing.empty())
+    return;
+
+  std::vector<uint256> computed(missing.size());
+  scrypt_1024_1_1_256_multi(input.data(), (char *)computed.data(),
+                            missing.size());
+  for (size_t j = 0; j < missing.size(); j++) {
+    hashes[missing[j]] = computed[j];
+    PoWHashCache().Put(blockHashes[missing[j]], computed[j]);
+  }
+}
+
+uint256 CBlockHeader::GetPoWHash() const { return GetPoWHash(GetHash()); }
+
+uint256 CBlockHeader::GetPoWHash(const uint256 &hash) const {
+  if (!IsScryptPoW()) {
+    if (nVersion >= 0x20000000 || GetPoWType() == POW_TYPE_SHA256)
+      return hash;
+    if (GetPoWType() != POW_TYPE_MINOTAURX)
+      return HIGH_HASH;
+  }
+
+  uint256 powHash;
+  if (PoWHashCache().Get(hash, powHash))
+    return powHash;
+
+  powHash = ComputePoWHash();
+  PoWHashCache().Put(hash, powHash);
+  return powHash;
+}
+
+uint256 CBlockHeader::ComputePoWHash() const {
+  if (!IsScryptPoW()) {
     if (nVersion >= 0x20000000)
 
       return GetHash();
@@ -63,8 +63,21 @@ public:
 
   uint256 GetPoWHash() const;
 
+  uint256 GetPoWHash(const uint256 &hash) const;
+
+  // Uncached; use this when grinding nonces so tried headers stay out of the
+  // PoW hash cache.
+  uint256 ComputePoWHash() const;
+
+  bool IsScryptPoW() const;
+
+  static void GetScryptPoWHashes(const CBlockHeader *headers, size_t count,
+                                 uint256 *hashes);
+
   static uint256 MinotaurHashArbitrary(const char *data);
 
+  static uint256 MinotaurHashArbitrary(const char *data, size_t len);
+
   static uint256 MinotaurHashString(std::string data);
 
   int64_t GetBlockTime() const { return (int64_t)nTime; }
@@ -3,7 +3,9 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <crypto/aes.h>
+#include <crypto/common.h>
 #include <crypto/hmac_sha256.h>
+#include <crypto/minotaurx/minotaur.h>
 #include <crypto/sha512.h>
 #include <key.h>
 #include <pubkey.h>
@@ -18,7 +20,12 @@
 
 #include <boost/algorithm/string.hpp>
 
+#include <atomic>
 #include <iomanip>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <thread>
 
 std::vector<RialtoQueuedMessage> receivedMessageQueue;
 std::mutex receivedMessageQueueMutex;
@@ -26,8 +33,10 @@ std::condition_variable receivedMessageQueueCV;
 
 CRialtoWhitePagesDB::CRialtoWhitePagesDB(std::string dbName, size_t nCacheSize,
                                          bool fMemory, bool fWipe)
-    : CDBWrapper(GetDataDir() / dbName, nCacheSize, fMemory, fWipe) {
-  LogPrintf("Rialto: DB online: %s\n", dbName);
+    : CDBWrapper(GetDataDir() / dbName, nCacheSize, fMemory, fWipe),
+      stats() {
+  RebuildBloom();
+  LogPrintf("Rialto: DB online: %s (%u nicks)\n", dbName, nBloomElements);
 
 #ifdef THIS_CODE_DISABLED
   LogPrintf("%s Entry Dump:\n", dbName);
@@ -37,22 +46,118 @@ CRialtoWhitePagesDB::CRialtoWhitePagesDB(std::string dbName, size_t nCacheSize,
 #endif
 }
 
+void CRialtoWhitePagesDB::CacheInsert(const std::string &nick,
+                                      const std::string &pubKey) {
+  auto it = cacheIndex.find(nick);
+  if (it != cacheIndex.end()) {
+    it->second->second = pubKey;
+    lru.splice(lru.begin(), lru, it->second);
+    return;
+  }
+
+  lru.emplace_front(nick, pubKey);
+  cacheIndex[nick] = lru.begin();
+  if (lru.size() > RIALTO_WHITEPAGES_CACHE_ENTRIES) {
+    cacheIndex.erase(lru.back().first);
+    lru.pop_back();
+  }
+}
+
+void CRialtoWhitePagesDB::CacheErase(const std::string &nick) {
+  auto it = cacheIndex.find(nick);
+  if (it == cacheIndex.end())
+    return;
+  lru.erase(it->second);
+  cacheIndex.erase(it);
+}
+
+void CRialtoWhitePagesDB::BloomInsert(const std::string &nick) {
+  if (++nBloomElements > nBloomCapacity) {
+    RebuildBloom();
+    return;
+  }
+  bloom.insert(std::vector<unsigned char>(nick.begin(), nick.end()));
+}
+
+void CRialtoWhitePagesDB::RebuildBloom() {
+  std::vector<std::pair<std::string, std::string>> all = GetAll();
+  nBloomElements = all.size();
+  nBloomCapacity =
+      std::max(RIALTO_WHITEPAGES_BLOOM_MIN_ELEMENTS, nBloomElements * 2);
+  bloom = CBloomFilter(nBloomCapacity, RIALTO_WHITEPAGES_BLOOM_FP_RATE,
+                       GetRand(std::numeric_limits<unsigned int>::max()),
+                       BLOOM_UPDATE_NONE);
+  for (const auto &entry : all)
+    bloom.insert(
+        std::vector<unsigned char>(entry.first.begin(), entry.first.end()));
+}
+
 bool CRialtoWhitePagesDB::GetPubKeyForNick(const std::string nick,
                                            std::string &pubKey) {
-  return Read(nick, pubKey);
+  LOCK(cs_cache);
+  auto it = cacheIndex.find(nick);
+  if (it != cacheIndex.end()) {
+    stats.nHits++;
+    lru.splice(lru.begin(), lru, it->second);
+    pubKey = it->second->second;
+    return true;
+  }
+
+  if (!bloom.contains(std::vector<unsigned char>(nick.begin(), nick.end()))) {
+    stats.nFiltered++;
+    return false;
+  }
+
+  stats.nMisses++;
+  if (!Read(nick, pubKey))
+    return false;
+  CacheInsert(nick, pubKey);
+  return true;
 }
 
 bool CRialtoWhitePagesDB::SetPubKeyForNick(const std::string nick,
                                            const std::string pubKey) {
-  return Write(nick, pubKey);
+  LOCK(cs_cache);
+  if (!Write(nick, pubKey))
+    return false;
+  BloomInsert(nick);
+  CacheInsert(nick, pubKey);
+  return true;
 }
 
 bool CRialtoWhitePagesDB::RemoveNick(const std::string nick) {
+  LOCK(cs_cache);
+  CacheErase(nick);
   return Erase(nick);
 }
 
 bool CRialtoWhitePagesDB::NickExists(const std::string nick) {
-  return Exists(nick);
+  std::string pubKey;
+  return GetPubKeyForNick(nick, pubKey);
+}
+
+bool CRialtoWhitePagesDB::ReplaceAll(
+    const std::map<std::string, std::string> &nicks) {
+  LOCK(cs_cache);
+  CDBBatch batch(*this);
+  for (const auto &entry : GetAll())
+    if (!nicks.count(entry.first))
+      batch.Erase(entry.first);
+  for (const auto &entry : nicks)
+    batch.Write(entry.first, entry.second);
+
+  lru.clear();
+  cacheIndex.clear();
+  bool fWritten = WriteBatch(batch, true);
+  RebuildBloom();
+  return fWritten;
+}
+
+CRialtoWhitePagesCacheStats CRialtoWhitePagesDB::GetCacheStats() {
+  LOCK(cs_cache);
+  CRialtoWhitePagesCacheStats result = stats;
+  result.nCached = lru.size();
+  return result;
 }
 
 std::vector<std::pair<std::string, std::string>> CRialtoWhitePagesDB::GetAll() {
@@ -79,6 +184,135 @@ static void RialtoIncorrectAPIUsageCallback(const char *str, void *data) {
            "Rialto: WARNING: SECP256K1 INCORRECT API USAGE. str=%s\n", str);
 }
 
+static const secp256k1_context *RialtoGetContext() {
+  static secp256k1_context *ctx = nullptr;
+  static std::once_flag ctxFlag;
+  std::call_once(ctxFlag, []() {
+    ctx = secp256k1_context_create(SECP256K1_CONTEXT_SIGN);
+    if (!ctx)
+      return;
+    secp256k1_context_set_illegal_callback(
+        ctx, RialtoIncorrectAPIUsageCallback, NULL);
+
+    std::vector<unsigned char, secure_allocator<unsigned char>> contextSeed(
+        32);
+    GetStrongRandBytes(contextSeed.data(), 32);
+    if (!secp256k1_context_randomize(ctx, contextSeed.data())) {
+      secp256k1_context_destroy(ctx);
+      ctx = nullptr;
+    }
+  });
+  return ctx;
+}
+
+// Keyed with the public white pages key, so anyone can compute every nick's
+// tag: the tag is a bucketing hint that reveals which 1/256 of the white pages
+// a message is for. It is rotated each epoch but is not a secret.
+unsigned char RialtoRecipientTag(const std::vector<unsigned char> &pubKey,
+                                 uint32_t timestamp) {
+  static const std::string domain = "RialtoRecipientTag";
+  unsigned char epoch[4];
+  WriteLE32(epoch, timestamp / RIALTO_RECIPIENT_TAG_EPOCH);
+
+  unsigned char mac[CHMAC_SHA256::OUTPUT_SIZE];
+  CHMAC_SHA256(pubKey.data(), pubKey.size())
+      .Write((const unsigned char *)domain.data(), domain.size())
+      .Write(epoch, 4)
+      .Finalize(mac);
+  return mac[0];
+}
+
+const std::vector<size_t> &
+CRialtoLocalKeyCache::GetTagBucket(uint32_t timestamp, unsigned char tag) {
+  const uint32_t epoch = timestamp / RIALTO_RECIPIENT_TAG_EPOCH;
+  auto it = tagBuckets.find(epoch);
+  if (it == tagBuckets.end()) {
+    std::vector<std::vector<size_t>> buckets(256);
+    for (size_t i = 0; i < keys.size(); i++)
+      buckets[RialtoRecipientTag(keys[i].pubKey, timestamp)].push_back(i);
+
+    while (tagBuckets.size() >= RIALTO_RECIPIENT_TAG_EPOCHS_CACHED)
+      tagBuckets.erase(tagBuckets.begin());
+    it = tagBuckets.emplace(epoch, std::move(buckets)).first;
+  }
+  return it->second[tag];
+}
+
+std::vector<RialtoLocalKey> CRialtoLocalKeyCache::Get(const Loader &loader,
+                                                      uint32_t timestamp,
+                                                      int tag) {
+  uint64_t nLoadGeneration;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (fValid) {
+      if (tag < 0)
+        return keys;
+
+      std::vector<RialtoLocalKey> candidates;
+      for (size_t i : GetTagBucket(timestamp, tag))
+        candidates.push_back(keys[i]);
+      return candidates;
+    }
+    nLoadGeneration = nGeneration;
+  }
+
+  std::vector<RialtoLocalKey> loaded;
+  if (loader(loaded)) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (nGeneration == nLoadGeneration) {
+      keys = loaded;
+      tagBuckets.clear();
+      fValid = true;
+    }
+  }
+
+  if (tag >= 0)
+    loaded.erase(std::remove_if(loaded.begin(), loaded.end(),
+                                [&](const RialtoLocalKey &key) {
+                                  return RialtoRecipientTag(key.pubKey,
+                                                            timestamp) != tag;
+                                }),
+                 loaded.end());
+  return loaded;
+}
+
+void CRialtoLocalKeyCache::Invalidate() {
+  std::lock_guard<std::mutex> lock(mutex);
+  keys.clear();
+  tagBuckets.clear();
+  fValid = false;
+  nGeneration++;
+}
+
+static CRialtoLocalKeyCache localKeyCache;
+
+static bool RialtoLoadLocalKeys(std::vector<RialtoLocalKey> &keys) {
+  bool fComplete = true;
+  for (const auto &n : RialtoGetAllLocal()) {
+    RialtoLocalKey key;
+    key.nick = n.first;
+    key.pubKey = ParseHex(n.second);
+    key.privKey.resize(32);
+    if (!RialtoGetLocalPrivKeyForNick(n.first, key.privKey.data())) {
+      LogPrint(BCLog::RIALTO,
+               "Error: Can't find local privkey for nick %s. IS THE WALLET "
+               "LOCKED?\n",
+               n.first);
+      fComplete = false;
+      continue;
+    }
+    keys.push_back(key);
+  }
+  return fComplete;
+}
+
+void RialtoInvalidateLocalKeyCache() { localKeyCache.Invalidate(); }
+
+static std::vector<RialtoLocalKey> RialtoGetLocalKeys(uint32_t timestamp = 0,
+                                                      int tag = -1) {
+  return localKeyCache.Get(RialtoLoadLocalKeys, timestamp, tag);
+}
+
 template <typename T> std::string IntToHexStr(T i) {
   std::stringstream stream;
   stream << std::setfill('0') << std::setw(sizeof(T) * 2) << std::hex << i;
@@ -110,7 +344,8 @@ bool RialtoIsValidPlaintext(const std::string plaintext) {
   return true;
 }
 
-bool RialtoParseLayer3Envelope(const std::string ciphertext, std::string &err,
+bool RialtoCheckLayer3Envelope(const std::string &ciphertext,
+                               std::string &err, std::string &powInput,
                                std::string *layer2Envelope,
                                uint32_t *timestamp) {
   if (ciphertext.size() < RIALTO_L3_MIN_LENGTH * 2) {
@@ -121,6 +356,9 @@ bool RialtoParseLayer3Envelope(const std::string ciphertext, std::string &err,
           std::to_string(RIALTO_L3_MAX_LENGTH) + ", found " +
           std::to_string(ciphertext.size()) + ").";
     return false;
+  } else if (!IsHex(ciphertext)) {
+    err = "Layer 3 envelope is not hex.";
+    return false;
   }
 
   uint32_t nonce = std::stoul(ciphertext.substr(0, 8), nullptr, 16);
@@ -136,14 +374,7 @@ bool RialtoParseLayer3Envelope(const std::string ciphertext, std::string &err,
     return false;
   }
 
-  std::string dataToHash = IntToHexStr(t) + e;
-  arith_uint256 hash = arith_uint256(
-      CBlockHeader::MinotaurHashString(dataToHash + std::to_string(nonce))
-          .ToString());
-  if (hash > RIALTO_MESSAGE_POW_TARGET) {
-    err = "Message doesn't meet PoW target.";
-    return false;
-  }
+  powInput = IntToHexStr(t) + e + std::to_string(nonce);
 
   if (timestamp)
     *timestamp = t;
@@ -154,9 +385,95 @@ bool RialtoParseLayer3Envelope(const std::string ciphertext, std::string &err,
   return true;
 }
 
-bool RialtoEncryptMessage(const std::string nickFrom, const std::string nickTo,
-                          const std::string plaintext, std::string &ciphertext,
-                          uint32_t &timestampSent, std::string &err) {
+bool RialtoParseLayer3Envelope(const std::string ciphertext, std::string &err,
+                               std::string *layer2Envelope,
+                               uint32_t *timestamp) {
+  std::string powInput;
+  if (!RialtoCheckLayer3Envelope(ciphertext, err, powInput, layer2Envelope,
+                                 timestamp))
+    return false;
+
+  arith_uint256 hash =
+      UintToArith256(CBlockHeader::MinotaurHashString(powInput));
+  if (hash > RIALTO_MESSAGE_POW_TARGET) {
+    err = "Message doesn't meet PoW target.";
+    return false;
+  }
+
+  return true;
+}
+
+int RialtoGetPoWThreadCount() {
+  int coreCount = GetNumVirtualCores();
+  int threadCount =
+      gArgs.GetArg("-rialtopowthreads", DEFAULT_RIALTO_POW_THREADS);
+  if (threadCount == -2)
+    threadCount = std::max(1, coreCount - 1);
+  else if (threadCount < 0 || threadCount > coreCount)
+    threadCount = coreCount;
+  else if (threadCount == 0)
+    threadCount = 1;
+  return threadCount;
+}
+
+static size_t RialtoWriteDecimal(uint32_t n, unsigned char *out) {
+  unsigned char digits[10];
+  size_t len = 0;
+  do {
+    digits[len++] = '0' + n % 10;
+    n /= 10;
+  } while (n);
+  for (size_t i = 0; i < len; i++)
+    out[i] = digits[len - 1 - i];
+  return len;
+}
+
+static void RialtoSearchNonces(const std::string &dataToHash, uint32_t first,
+                               uint32_t stride, std::atomic<bool> &found,
+                               uint32_t &nonceFound) {
+  std::vector<unsigned char> buf(dataToHash.begin(), dataToHash.end());
+  const size_t prefixLen = buf.size();
+  buf.resize(prefixLen + 10);
+  MinotaurHasher &hasher = MinotaurHasher::ForThisThread();
+
+  for (uint64_t nonce = first; nonce <= 0xffffffff; nonce += stride) {
+    if (found.load(std::memory_order_relaxed))
+      return;
+
+    size_t len = prefixLen + RialtoWriteDecimal(nonce, &buf[prefixLen]);
+    if (UintToArith256(hasher.Hash(buf.data(), len)) >
+        RIALTO_MESSAGE_POW_TARGET)
+      continue;
+
+    bool expected = false;
+    if (found.compare_exchange_strong(expected, true))
+      nonceFound = nonce;
+    return;
+  }
+}
+
+bool RialtoFindMessageNonce(const std::string &dataToHash, int threadCount,
+                            uint32_t &nonce) {
+  if (threadCount < 1)
+    threadCount = 1;
+
+  std::atomic<bool> found(false);
+  std::vector<std::thread> threads;
+  for (int i = 1; i < threadCount; i++)
+    threads.emplace_back(RialtoSearchNonces, std::cref(dataToHash), i,
+                         threadCount, std::ref(found), std::ref(nonce));
+  RialtoSearchNonces(dataToHash, 0, threadCount, found, nonce);
+  for (std::thread &thread : threads)
+    thread.join();
+
+  return found;
+}
+
+bool RialtoBuildLayer2Envelope(const std::string nickFrom,
+                               const std::string nickTo,
+                               const std::string plaintext,
+                               std::string &dataToHash, uint32_t &now,
+                               std::string &err) {
   if (!RialtoIsValidPlaintext(plaintext)) {
     err = "Plaintext is invalid; 1-160 printable characters only. Cannot "
           "contain only spaces.";
@@ -179,7 +496,7 @@ bool RialtoEncryptMessage(const std::string nickFrom, const std::string nickTo,
     return false;
   }
 
-  uint32_t now = GetAdjustedTime();
+  now = GetAdjustedTime();
   std::string nowStr = IntToHexStr(now);
 
   std::vector<unsigned char, secure_allocator<unsigned char>> layer1EnvelopeVec(
@@ -226,54 +543,37 @@ bool RialtoEncryptMessage(const std::string nickFrom, const std::string nickTo,
     err = "Can't find recipient pubkey in white pages.";
     return false;
   }
-  CPubKey destPubKey(ParseHex(destPubKeyStr));
+  std::vector<unsigned char> destPubKeyVec = ParseHex(destPubKeyStr);
+  CPubKey destPubKey(destPubKeyVec);
 
   std::vector<unsigned char, secure_allocator<unsigned char>> IV(16);
   GetStrongRandBytes(IV.data(), 16);
 
-  std::vector<unsigned char, secure_allocator<unsigned char>> contextSeed(32);
-  GetStrongRandBytes(contextSeed.data(), 32);
-
-  secp256k1_context *ctx = secp256k1_context_create(SECP256K1_CONTEXT_SIGN);
-
+  const secp256k1_context *ctx = RialtoGetContext();
   if (!ctx) {
     err = "Couldn't create secp256k1 context.";
     return false;
   }
 
-  secp256k1_context_set_illegal_callback(ctx, RialtoIncorrectAPIUsageCallback,
-                                         NULL);
-
-  if (!secp256k1_context_randomize(ctx, contextSeed.data())) {
-    err = "Couldn't randomise context.";
-    secp256k1_context_destroy(ctx);
-    return false;
-  }
-
   secp256k1_pubkey destPubKeyParsed;
   if (!secp256k1_ec_pubkey_parse(ctx, &destPubKeyParsed, destPubKey.begin(),
                                  destPubKey.size())) {
     err = "Couldn't parse the destination pubkey.";
-    secp256k1_context_destroy(ctx);
     return false;
   }
 
-  CKey *ephemeralKey = new CKey();
-  ephemeralKey->MakeNewKey(true);
+  CKey ephemeralKey;
+  ephemeralKey.MakeNewKey(true);
 
-  CPubKey ephemeralPubKey = ephemeralKey->GetPubKey();
+  CPubKey ephemeralPubKey = ephemeralKey.GetPubKey();
 
   std::vector<unsigned char, secure_allocator<unsigned char>> sharedSecret(32);
   if (!secp256k1_ecdh(ctx, sharedSecret.data(), &destPubKeyParsed,
-                      ephemeralKey->begin())) {
+                      ephemeralKey.begin())) {
     err = "Couldn't perform ECDH to get shared secret.";
-    secp256k1_context_destroy(ctx);
     return false;
   }
 
-  memory_cleanse((void *)ephemeralKey->begin(), 32);
-  secp256k1_context_destroy(ctx);
-
   std::vector<unsigned char, secure_allocator<unsigned char>> sharedSecretHash(
       64);
   CSHA512 hasher;
@@ -299,8 +599,17 @@ bool RialtoEncryptMessage(const std::string nickFrom, const std::string nickTo,
   memory_cleanse(layer1EnvelopeVec.data(), layer1EnvelopeVec.size());
   memory_cleanse(keyEncryption.data(), 32);
 
+  std::vector<unsigned char> tagHeader;
+  const size_t layer2Size = 16 + ephemeralPubKey.size() + encrypted.size() +
+                            32 + RIALTO_L2_TAG_HEADER_LENGTH;
+  if (gArgs.GetBoolArg("-rialtorecipienttag", DEFAULT_RIALTO_RECIPIENT_TAG) &&
+      layer2Size <= RIALTO_L2_MAX_LENGTH + RIALTO_L2_TAG_HEADER_LENGTH)
+    tagHeader = {RIALTO_L2_VERSION_TAGGED,
+                 RialtoRecipientTag(destPubKeyVec, now)};
+
   CHMAC_SHA256 macer(keyMAC.data(), 32);
-  macer.Write(IV.data(), 16)
+  macer.Write(tagHeader.data(), tagHeader.size())
+      .Write(IV.data(), 16)
       .Write(ephemeralPubKey.begin(), ephemeralPubKey.size())
       .Write(encrypted.data(), encrypted.size());
 
@@ -309,6 +618,8 @@ bool RialtoEncryptMessage(const std::string nickFrom, const std::string nickTo,
   macer.Finalize(mac.data());
 
   std::vector<unsigned char, secure_allocator<unsigned char>> layer2EnvelopeVec;
+  layer2EnvelopeVec.insert(layer2EnvelopeVec.end(), tagHeader.begin(),
+                           tagHeader.end());
   layer2EnvelopeVec.insert(layer2EnvelopeVec.end(), IV.begin(), IV.end());
   layer2EnvelopeVec.insert(layer2EnvelopeVec.end(), ephemeralPubKey.begin(),
                            ephemeralPubKey.end());
@@ -316,30 +627,73 @@ bool RialtoEncryptMessage(const std::string nickFrom, const std::string nickTo,
                            encrypted.end());
   layer2EnvelopeVec.insert(layer2EnvelopeVec.end(), mac.begin(), mac.end());
 
-  uint32_t nonce = 0;
-  std::string dataToHash =
+  dataToHash =
       nowStr + HexStr(layer2EnvelopeVec.begin(), layer2EnvelopeVec.end());
+  return true;
+}
 
-  while (true) {
-    arith_uint256 currentHash = arith_uint256(
-        CBlockHeader::MinotaurHashString(dataToHash + std::to_string(nonce))
-            .ToString());
-    if (currentHash <= RIALTO_MESSAGE_POW_TARGET)
-      break;
+bool RialtoEncryptMessage(const std::string nickFrom, const std::string nickTo,
+                          const std::string plaintext, std::string &ciphertext,
+                          uint32_t &timestampSent, std::string &err) {
+  std::string dataToHash;
+  uint32_t now;
+  if (!RialtoBuildLayer2Envelope(nickFrom, nickTo, plaintext, dataToHash, now,
+                                 err))
+    return false;
 
-    nonce++;
-    if (nonce == 0) {
-      err = "PoW Nonce overflow.";
-      return false;
-    }
+  uint32_t nonce;
+  if (!RialtoFindMessageNonce(dataToHash, RialtoGetPoWThreadCount(), nonce)) {
+    err = "PoW Nonce overflow.";
+    return false;
   }
 
-  ciphertext = IntToHexStr(nonce) + nowStr +
-               HexStr(layer2EnvelopeVec.begin(), layer2EnvelopeVec.end());
+  ciphertext = IntToHexStr(nonce) + dataToHash;
   timestampSent = now;
   return true;
 }
 
+void RialtoEncryptMessages(std::vector<RialtoOutgoingMessage> &messages) {
+  if (messages.empty())
+    return;
+
+  int threadCount = RialtoGetPoWThreadCount();
+  int workerCount = std::min<int>(threadCount, messages.size());
+  int threadsPerMessage = std::max(1, threadCount / workerCount);
+
+  // Each envelope is built, and so timestamped, just before its own nonce
+  // search, so messages late in the batch don't spend their TTL waiting.
+  std::atomic<size_t> cursor(0);
+  auto worker = [&]() {
+    for (size_t next = cursor++; next < messages.size(); next = cursor++) {
+      RialtoOutgoingMessage &msg = messages[next];
+      msg.fSuccess = false;
+      std::string dataToHash;
+      if (!RialtoBuildLayer2Envelope(msg.nickFrom, msg.nickTo, msg.plaintext,
+                                     dataToHash, msg.timestampSent, msg.err))
+        continue;
+
+      uint32_t nonce;
+      if (!RialtoFindMessageNonce(dataToHash, threadsPerMessage, nonce)) {
+        msg.err = "PoW Nonce overflow.";
+        continue;
+      }
+      if (GetAdjustedTime() > msg.timestampSent + RIALTO_MESSAGE_TTL) {
+        msg.err = "Message expired before its PoW was found.";
+        continue;
+      }
+      msg.ciphertext = IntToHexStr(nonce) + dataToHash;
+      msg.fSuccess = true;
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (int i = 1; i < workerCount; i++)
+    threads.emplace_back(worker);
+  worker();
+  for (std::thread &thread : threads)
+    thread.join();
+}
+
 bool RialtoDecryptMessage(const std::string layer3Envelope, std::string &err) {
   std::string layer2Envelope;
   uint32_t layer3timestamp;
@@ -347,85 +701,76 @@ bool RialtoDecryptMessage(const std::string layer3Envelope, std::string &err) {
                                  &layer3timestamp))
     return false;
 
+  return RialtoDecryptLayer2Envelope(layer2Envelope, layer3timestamp, err);
+}
+
+bool RialtoDecryptLayer2Envelope(const std::string &layer2Envelope,
+                                 uint32_t layer3timestamp, std::string &err) {
   if (layer2Envelope.size() < RIALTO_L2_MIN_LENGTH * 2) {
     err = "Layer 2 envelope is too short.";
     return false;
-  } else if (layer2Envelope.size() > RIALTO_L2_MAX_LENGTH * 2) {
+  } else if (!IsHex(layer2Envelope)) {
+    err = "Layer 2 envelope is not hex.";
+    return false;
+  }
+
+  std::vector<unsigned char> tagHeader;
+  if ((layer2Envelope.size() / 2 - 16 - 33 - 32) % AES_BLOCKSIZE ==
+      RIALTO_L2_TAG_HEADER_LENGTH) {
+    tagHeader =
+        ParseHex(layer2Envelope.substr(0, RIALTO_L2_TAG_HEADER_LENGTH * 2));
+    if (tagHeader[0] != RIALTO_L2_VERSION_TAGGED) {
+      err = "Unknown layer 2 envelope version.";
+      return false;
+    }
+  }
+
+  if (layer2Envelope.size() > (RIALTO_L2_MAX_LENGTH + tagHeader.size()) * 2) {
     err = "Layer 2 envelope is too long.";
     return false;
   }
 
-  std::vector<unsigned char> IV = ParseHex(layer2Envelope.substr(0, 32));
-  std::vector<unsigned char> ephemeralPubKey =
-      ParseHex(layer2Envelope.substr(32, 66));
+  const std::string body = layer2Envelope.substr(tagHeader.size() * 2);
+  std::vector<unsigned char> IV = ParseHex(body.substr(0, 32));
+  std::vector<unsigned char> ephemeralPubKey = ParseHex(body.substr(32, 66));
   std::vector<unsigned char> encrypted =
-      ParseHex(layer2Envelope.substr(98, layer2Envelope.size() - 98 - 64));
-  std::vector<unsigned char> mac =
-      ParseHex(layer2Envelope.substr(layer2Envelope.size() - 64, 64));
+      ParseHex(body.substr(98, body.size() - 98 - 64));
+  std::vector<unsigned char> mac = ParseHex(body.substr(body.size() - 64, 64));
 
   if (encrypted.size() % AES_BLOCKSIZE != 0) {
     err = "Encrypted data is not a multiple of AES_BLOCKSIZE bytes.";
     return false;
   }
 
-  secp256k1_context *ctx = secp256k1_context_create(SECP256K1_CONTEXT_SIGN);
-
+  const secp256k1_context *ctx = RialtoGetContext();
   if (!ctx) {
     err = "Couldn't create secp256k1 context.";
     return false;
   }
-  secp256k1_context_set_illegal_callback(ctx, RialtoIncorrectAPIUsageCallback,
-                                         NULL);
 
   secp256k1_pubkey ephemeralPubKeyParsed;
   if (!secp256k1_ec_pubkey_parse(ctx, &ephemeralPubKeyParsed,
                                  ephemeralPubKey.data(),
                                  ephemeralPubKey.size())) {
     err = "Couldn't parse the ephemeral pubkey.";
-    secp256k1_context_destroy(ctx);
     return false;
   }
 
-  std::vector<std::pair<std::string, std::string>> nicks = RialtoGetAllLocal();
-  for (auto n : nicks) {
-    std::vector<unsigned char, secure_allocator<unsigned char>> privKeyData(32);
-    if (!RialtoGetLocalPrivKeyForNick(n.first, privKeyData.data())) {
-      LogPrint(BCLog::RIALTO,
-               "Error: Can't find local privkey for nick %s. IS THE WALLET "
-               "LOCKED?\n",
-               n.first);
-      continue;
-    }
-
-    std::vector<unsigned char, secure_allocator<unsigned char>> contextSeed(32);
-    GetStrongRandBytes(contextSeed.data(), 32);
-
-    if (!secp256k1_context_randomize(ctx, contextSeed.data())) {
-      LogPrint(BCLog::RIALTO,
-               "Error: Couldn't randomise context when trying as %s\n",
-               n.first);
-      memory_cleanse(privKeyData.data(), 32);
-
-      continue;
-    }
-
+  const int tag = tagHeader.empty() ? -1 : tagHeader[1];
+  for (const RialtoLocalKey &n : RialtoGetLocalKeys(layer3timestamp, tag)) {
     std::vector<unsigned char, secure_allocator<unsigned char>> sharedSecret(
         32);
     if (!secp256k1_ecdh(ctx, sharedSecret.data(), &ephemeralPubKeyParsed,
-                        privKeyData.data())) {
+                        n.privKey.data())) {
       LogPrint(BCLog::RIALTO,
                "Error: Couldn't perform ECDH to get shared secret when trying "
                "as %s\n",
-               n.first);
-      memory_cleanse(privKeyData.data(), 32);
-
+               n.nick);
       memory_cleanse(sharedSecret.data(), 32);
 
       continue;
     }
 
-    memory_cleanse(privKeyData.data(), 32);
-
     std::vector<unsigned char, secure_allocator<unsigned char>>
         sharedSecretHash(64);
     CSHA512 hasher;
@@ -442,7 +787,8 @@ bool RialtoDecryptMessage(const std::string layer3Envelope, std::string &err) {
     memory_cleanse(sharedSecretHash.data(), 64);
 
     CHMAC_SHA256 macer(keyMAC.data(), 32);
-    macer.Write(IV.data(), 16)
+    macer.Write(tagHeader.data(), tagHeader.size())
+        .Write(IV.data(), 16)
         .Write(ephemeralPubKey.data(), ephemeralPubKey.size())
         .Write(encrypted.data(), encrypted.size());
 
@@ -467,11 +813,9 @@ bool RialtoDecryptMessage(const std::string layer3Envelope, std::string &err) {
 
     if (layer1EnvelopeVec.size() < RIALTO_L1_MIN_LENGTH) {
       err = "Layer 1 envelope is too short.";
-      secp256k1_context_destroy(ctx);
       return false;
     } else if (layer1EnvelopeVec.size() > RIALTO_L1_MAX_LENGTH) {
       err = "Layer 1 envelope is too long.";
-      secp256k1_context_destroy(ctx);
       return false;
     }
 
@@ -491,7 +835,10 @@ bool RialtoDecryptMessage(const std::string layer3Envelope, std::string &err) {
 
     if (firstNull == 0 || secondNull == 0 || thirdNull == 0) {
       err = "Nulls missing in layer1EnvelopeVec.";
-      secp256k1_context_destroy(ctx);
+      return false;
+    }
+    if (secondNull < firstNull + 9) {
+      err = "Layer 1 envelope timestamp is missing.";
       return false;
     }
 
@@ -512,40 +859,38 @@ bool RialtoDecryptMessage(const std::string layer3Envelope, std::string &err) {
     std::vector<unsigned char> encapsulatedMessage(
         layer1EnvelopeVec.begin(), layer1EnvelopeVec.begin() + thirdNull + 1);
 
+    if (!IsHex(layer1timestampStr)) {
+      err = "Layer 1 envelope timestamp is not hex.";
+      return false;
+    }
     uint32_t layer1timestamp = std::stoul(layer1timestampStr, nullptr, 16);
     if (layer1timestamp != layer3timestamp) {
       err = "Layer 1 / Layer 3 Envelope timestamp mismatch.";
-      secp256k1_context_destroy(ctx);
       return false;
     }
 
     if (!RialtoIsValidNickFormat(unconfirmedDestinationNick)) {
       err = "Invalid destination nick format. Shenanigans!";
-      secp256k1_context_destroy(ctx);
       return false;
     }
     if (!RialtoIsValidNickFormat(unconfirmedSenderNick)) {
       err = "Invalid sender nick. Shenanigans!";
-      secp256k1_context_destroy(ctx);
       return false;
     }
 
-    if (unconfirmedDestinationNick != n.first) {
+    if (unconfirmedDestinationNick != n.nick) {
       err = "Destination nick doesn't match the nick we're trying to decrypt "
             "as. Possible repackaged-L1 replay attack. Shenanigans!";
-      secp256k1_context_destroy(ctx);
       return false;
     }
 
     if (RialtoNickIsBlocked(unconfirmedSenderNick)) {
       err = "Sender nick is blocked.";
-      secp256k1_context_destroy(ctx);
       return false;
     }
 
     if (!RialtoIsValidPlaintext(unconfirmedPlaintext)) {
       err = "Invalid plaintext.";
-      secp256k1_context_destroy(ctx);
       return false;
     }
 
@@ -553,7 +898,6 @@ bool RialtoDecryptMessage(const std::string layer3Envelope, std::string &err) {
     if (!RialtoGetGlobalPubKeyForNick(unconfirmedSenderNick,
                                       whitePagesPubKey)) {
       err = "Can't find pubkey for sending nick in White Pages.";
-      secp256k1_context_destroy(ctx);
       return false;
     }
     std::vector<unsigned char> whitePagesPubKeyVec = ParseHex(whitePagesPubKey);
@@ -563,13 +907,11 @@ bool RialtoDecryptMessage(const std::string layer3Envelope, std::string &err) {
     CPubKey sigPubKey;
     if (!sigPubKey.RecoverCompact(messageHash, messageSig)) {
       err = "Strange format. Couldn't recover a pubkey from the message sig.";
-      secp256k1_context_destroy(ctx);
       return false;
     }
 
     if (memcmp(sigPubKey.begin(), whitePagesPubKeyVec.data(), 33) != 0) {
       err = "Forgery. Pubkey from sig doesn't match pubkey from white pages.";
-      secp256k1_context_destroy(ctx);
       return false;
     }
 
@@ -586,12 +928,10 @@ bool RialtoDecryptMessage(const std::string layer3Envelope, std::string &err) {
     receivedMessageQueue.push_back(qm);
     receivedMessageQueueCV.notify_one();
 
-    secp256k1_context_destroy(ctx);
     return true;
   }
 
   err = "Not for us.";
-  secp256k1_context_destroy(ctx);
   return false;
 }
 
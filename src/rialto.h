@@ -6,16 +6,40 @@
 #define LITECOINCASH_RIALTO_H
 
 #include <arith_uint256.h>
+#include <bloom.h>
 #include <dbwrapper.h>
+#include <hash.h>
 #include <support/allocators/secure.h>
+#include <sync.h>
 
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 
 const arith_uint256 RIALTO_MESSAGE_POW_TARGET = arith_uint256(
     "0000ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff");
 
 const int RIALTO_MESSAGE_TTL = 15 * 60;
 
+static const int DEFAULT_RIALTO_POW_THREADS = -2;
+
+static const size_t MAX_RIALTO_ENCRYPT_BATCH = 50;
+
+static const int DEFAULT_RIALTO_VERIFY_THREADS = 2;
+
+static const bool DEFAULT_RIALTO_RECIPIENT_TAG = false;
+
+const unsigned char RIALTO_L2_VERSION_TAGGED = 0x01;
+
+const int RIALTO_L2_TAG_HEADER_LENGTH = 1 + 1;
+
+const int RIALTO_RECIPIENT_TAG_EPOCH = 60 * 60;
+
+const size_t RIALTO_RECIPIENT_TAG_EPOCHS_CACHED = 4;
+
 const int RIALTO_L1_MIN_LENGTH = 1 + 1 + 8 + 3 + 1 + 3 + 1 + 65;
 
 const int RIALTO_L1_MAX_LENGTH = 160 + 1 + 8 + 20 + 1 + 20 + 1 + 65;
@@ -28,7 +52,36 @@ const int RIALTO_L3_MIN_LENGTH = 8 + 8 + RIALTO_L2_MIN_LENGTH;
 
 const int RIALTO_L3_MAX_LENGTH = 8 + 8 + RIALTO_L2_MAX_LENGTH;
 
+const size_t RIALTO_WHITEPAGES_CACHE_ENTRIES = 10000;
+
+const size_t RIALTO_WHITEPAGES_BLOOM_MIN_ELEMENTS = 10000;
+
+const double RIALTO_WHITEPAGES_BLOOM_FP_RATE = 0.001;
+
+struct CRialtoWhitePagesCacheStats {
+  size_t nCached;
+  uint64_t nHits;
+  uint64_t nMisses;
+  uint64_t nFiltered;
+};
+
 class CRialtoWhitePagesDB : public CDBWrapper {
+private:
+  typedef std::list<std::pair<std::string, std::string>> LRUList;
+
+  CCriticalSection cs_cache;
+  LRUList lru;
+  std::unordered_map<std::string, LRUList::iterator> cacheIndex;
+  CBloomFilter bloom;
+  size_t nBloomElements;
+  size_t nBloomCapacity;
+  CRialtoWhitePagesCacheStats stats;
+
+  void CacheInsert(const std::string &nick, const std::string &pubKey);
+  void CacheErase(const std::string &nick);
+  void BloomInsert(const std::string &nick);
+  void RebuildBloom();
+
 public:
   CRialtoWhitePagesDB(std::string dbName, size_t nCacheSize,
                       bool fMemory = false, bool fWipe = false);
@@ -37,8 +90,11 @@ public:
   bool SetPubKeyForNick(const std::string nick, const std::string pubKey);
   bool RemoveNick(const std::string nick);
   bool NickExists(const std::string nick);
+  bool ReplaceAll(const std::map<std::string, std::string> &nicks);
 
   std::vector<std::pair<std::string, std::string>> GetAll();
+
+  CRialtoWhitePagesCacheStats GetCacheStats();
 };
 
 class CRialtoMessage {
@@ -58,6 +114,17 @@ public:
   const std::string GetMessage() const { return message; }
 };
 
+struct RialtoOutgoingMessage {
+  std::string nickFrom;
+  std::string nickTo;
+  std::string plaintext;
+
+  bool fSuccess;
+  std::string ciphertext;
+  uint32_t timestampSent;
+  std::string err;
+};
+
 struct RialtoQueuedMessage {
   std::vector<unsigned char, secure_allocator<unsigned char>> fromNick;
   std::vector<unsigned char, secure_allocator<unsigned char>> toNick;
@@ -65,6 +132,37 @@ struct RialtoQueuedMessage {
   uint32_t timestamp;
 };
 
+struct RialtoLocalKey {
+  std::string nick;
+  std::vector<unsigned char> pubKey;
+  std::vector<unsigned char, secure_allocator<unsigned char>> privKey;
+};
+
+// Keys of the local nicks, loaded once and reused for every trial
+// decryption until Invalidate is called. Each invalidation bumps a
+// generation counter, so keys loaded while one happened are not cached.
+class CRialtoLocalKeyCache {
+public:
+  typedef std::function<bool(std::vector<RialtoLocalKey> &)> Loader;
+
+private:
+  std::mutex mutex;
+  std::vector<RialtoLocalKey> keys;
+  std::map<uint32_t, std::vector<std::vector<size_t>>> tagBuckets;
+  bool fValid;
+  uint64_t nGeneration;
+
+  const std::vector<size_t> &GetTagBucket(uint32_t timestamp,
+                                          unsigned char tag);
+
+public:
+  CRialtoLocalKeyCache() : fValid(false), nGeneration(0) {}
+
+  std::vector<RialtoLocalKey> Get(const Loader &loader, uint32_t timestamp = 0,
+                                  int tag = -1);
+  void Invalidate();
+};
+
 extern std::vector<RialtoQueuedMessage> receivedMessageQueue;
 extern std::mutex receivedMessageQueueMutex;
 extern std::condition_variable receivedMessageQueueCV;
@@ -73,6 +171,13 @@ bool RialtoIsValidPlaintext(const std::string plaintext);
 
 bool RialtoIsValidNickFormat(const std::string nick);
 
+// Checks a layer 3 envelope's format and timestamp but not its PoW. The
+// string its PoW hash is computed over is returned in powInput.
+bool RialtoCheckLayer3Envelope(const std::string &ciphertext,
+                               std::string &err, std::string &powInput,
+                               std::string *layer2Envelope = NULL,
+                               uint32_t *timestamp = NULL);
+
 bool RialtoParseLayer3Envelope(const std::string ciphertext, std::string &err,
                                std::string *layer2Envelope = NULL,
                                uint32_t *timestamp = NULL);
@@ -97,6 +202,27 @@ bool RialtoDecryptMessage(const std::string layer3Envelope,
 
 );
 
+void RialtoEncryptMessages(std::vector<RialtoOutgoingMessage> &messages);
+
+int RialtoGetPoWThreadCount();
+
+bool RialtoFindMessageNonce(const std::string &dataToHash, int threadCount,
+                            uint32_t &nonce);
+
+void RialtoInvalidateLocalKeyCache();
+
+unsigned char RialtoRecipientTag(const std::vector<unsigned char> &pubKey,
+                                 uint32_t timestamp);
+
+bool RialtoBuildLayer2Envelope(const std::string nickFrom,
+                               const std::string nickTo,
+                               const std::string plaintext,
+                               std::string &dataToHash, uint32_t &now,
+                               std::string &err);
+
+bool RialtoDecryptLayer2Envelope(const std::string &layer2Envelope,
+                                 uint32_t layer3timestamp, std::string &err);
+
 std::vector<RialtoQueuedMessage> RialtoGetQueuedMessages();
 
 #endif
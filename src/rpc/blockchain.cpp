@@ -63,7 +63,7 @@ double GetDifficulty(const CChain &chain, const CBlockIndex *blockindex,
   const Consensus::Params &consensusParams = Params().GetConsensus();
 
   if (getHiveDifficulty) {
-    while (!blockindex->GetBlockHeader().IsHiveMined(consensusParams)) {
+    while (!blockindex->IsHiveMined(consensusParams)) {
       if (!blockindex->pprev ||
           blockindex->nHeight < consensusParams.minHiveCheckBlock) {
         LogPrint(BCLog::HIVE,
@@ -75,8 +75,8 @@ double GetDifficulty(const CChain &chain, const CBlockIndex *blockindex,
     }
   } else {
     if (IsMinotaurXEnabled(blockindex, consensusParams)) {
-      while (blockindex->GetBlockHeader().IsHiveMined(consensusParams) ||
-             blockindex->GetBlockHeader().GetPoWType() != powType) {
+      while (blockindex->IsHiveMined(consensusParams) ||
+             blockindex->GetPoWType() != powType) {
         assert(blockindex->pprev);
         blockindex = blockindex->pprev;
         if (!IsMinotaurXEnabled(blockindex, consensusParams)) {
@@ -84,7 +84,7 @@ double GetDifficulty(const CChain &chain, const CBlockIndex *blockindex,
         }
       }
     } else {
-      while (blockindex->GetBlockHeader().IsHiveMined(consensusParams)) {
+      while (blockindex->IsHiveMined(consensusParams)) {
         assert(blockindex->pprev);
         blockindex = blockindex->pprev;
       }
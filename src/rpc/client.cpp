@@ -113,6 +113,8 @@ static const CRPCConvertParam vRPCConvertParams[] = {
 
     {"sethiveparams", 2, "hiveearlyabort"},
 
+    {"rialtoencryptbatch", 0, "messages"},
+
     {"decoderawtransaction", 1, "iswitness"},
     {"signrawtransaction", 1, "prevtxs"},
     {"signrawtransaction", 2, "privkeys"},
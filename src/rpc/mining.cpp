@@ -26,6 +26,8 @@
 #include <validationinterface.h>
 #include <warnings.h>
 
+#include <algorithm>
+#include <map>
 #include <memory>
 #include <stdint.h>
 
@@ -62,7 +64,7 @@ UniValue GetNetworkHashPS(int lookup, int height, POW_TYPE powType) {
     lookup = pb->nHeight;
 
   while (IsMinotaurXEnabled(pb, Params().GetConsensus()) &&
-         pb->GetBlockHeader().GetPoWType() != powType) {
+         pb->GetPoWType() != powType) {
     assert(pb->pprev);
     pb = pb->pprev;
   }
@@ -78,10 +80,14 @@ UniValue GetNetworkHashPS(int lookup, int height, POW_TYPE powType) {
   arith_uint256 workDiff = GetNumHashes(*pb, powType);
 
   for (int i = 0; i < lookup; i++) {
-    pb = pb->pprev;
+    if (pb->pprevSameKind && !pb->IsHiveMined(Params().GetConsensus()) &&
+        IsMinotaurXEnabled(pb->pprevSameKind, Params().GetConsensus()))
+      pb = pb->pprevSameKind;
+    else
+      pb = pb->pprev;
 
     while (IsMinotaurXEnabled(pb, Params().GetConsensus()) &&
-           pb->GetBlockHeader().GetPoWType() != powType) {
+           pb->GetPoWType() != powType) {
       assert(pb->pprev);
       pb = pb->pprev;
     }
@@ -110,9 +116,9 @@ UniValue sethiveparams(const JSONRPCRequest &request) {
         "sethiveparams ( hivecheckdelay, hivecheckthreads, hiveearlyout )\n"
         "\nSet hivemining optimisation parameters.\n"
         "\nArguments:\n"
-        "1. hivecheckdelay     (numeric, required, default=1) Time between "
-        "Hive checks in ms. This should be left at default unless performance "
-        "degradation is observed.\n"
+        "1. hivecheckdelay     (numeric, required, default=1) Minimum time "
+        "between Hive checks in ms. This should be left at default unless "
+        "performance degradation is observed.\n"
         "2. hivecheckthreads   (numeric, required, default=-2) Number of "
         "threads to use when checking bees, -1 for all available cores, or -2 "
         "for one less than all available cores.\n"
@@ -140,9 +146,9 @@ UniValue gethiveparams(const JSONRPCRequest &request) {
         "\nGet hivemining optimisation parameters.\n"
         "\nResult:\n"
         "{\n"
-        "  \"hivecheckdelay\" : n,             (numeric) Time between Hive "
-        "checks in ms. This should be left at default unless performance "
-        "degradation is observed.\n"
+        "  \"hivecheckdelay\" : n,             (numeric) Minimum time between "
+        "Hive checks in ms. This should be left at default unless "
+        "performance degradation is observed.\n"
         "  \"hivecheckthreads\" : n,           (numeric) Number of threads to "
         "use when checking bees, -1 for all available cores, or -2 for one "
         "less than all available cores.\n"
@@ -167,6 +173,141 @@ UniValue gethiveparams(const JSONRPCRequest &request) {
   return obj;
 }
 
+static std::vector<double> HiveHistogramBounds(double first, double last) {
+  std::vector<double> bounds;
+  for (double decade = first; decade <= last; decade *= 10)
+    for (double step : {1.0, 2.0, 5.0})
+      if (decade * step <= last)
+        bounds.push_back(decade * step);
+  return bounds;
+}
+
+static UniValue HiveHistogram(std::vector<double> values,
+                              const std::vector<double> &bounds) {
+  UniValue obj(UniValue::VOBJ);
+  obj.push_back(Pair("count", (int)values.size()));
+  if (values.empty())
+    return obj;
+
+  std::sort(values.begin(), values.end());
+  obj.push_back(Pair("min", values.front()));
+  obj.push_back(Pair("median", values[values.size() / 2]));
+  obj.push_back(Pair("max", values.back()));
+
+  UniValue buckets(UniValue::VOBJ);
+  size_t i = 0;
+  for (double bound : bounds) {
+    int count = 0;
+    for (; i < values.size() && values[i] <= bound; i++)
+      count++;
+    buckets.push_back(Pair(strprintf("<=%g", bound), count));
+  }
+  buckets.push_back(
+      Pair(strprintf(">%g", bounds.back()), (int)(values.size() - i)));
+  obj.push_back(Pair("buckets", buckets));
+  return obj;
+}
+
+UniValue gethivestats(const JSONRPCRequest &request) {
+  if (request.fHelp || request.params.size() != 0)
+    throw std::runtime_error(
+        "gethivestats\n"
+        "\nGet timings of recent Hive checks run by this node.\n"
+        "\nResult:\n"
+        "{\n"
+        "  \"rounds\" : n,                     (numeric) Number of Hive checks "
+        "recorded\n"
+        "  \"window\" : n,                     (numeric) Maximum number of "
+        "recent Hive checks kept\n"
+        "  \"results\" : { \"result\" : n, ... }, (object) Number of Hive "
+        "checks per outcome (mined, no solution, aborted, no bees, stale, "
+        "rejected or failed)\n"
+        "  \"tip_to_start_ms\" : {...},        (object) Histogram of the time "
+        "from tip arrival to the start of the Hive check\n"
+        "  \"getbcts_ms\" : {...},             (object) Histogram of the time "
+        "spent gathering BCTs from the wallet\n"
+        "  \"binning_ms\" : {...},             (object) Histogram of the time "
+        "spent splitting mature bees into chunks\n"
+        "  \"hashing_ms\" : {...},             (object) Histogram of the time "
+        "spent hashing bees\n"
+        "  \"solution_to_submit_ms\" : {...},  (object) Histogram of the time "
+        "from finding a solution to submitting the block\n"
+        "  \"bees_per_sec_per_thread\" : {...}, (object) Histogram of the "
+        "bee hashing rate of each check thread\n"
+        "  \"last\" : {...}                    (object) Timings of the most "
+        "recent Hive check\n"
+        "}\n"
+        "\nEach histogram has \"count\", \"min\", \"median\", \"max\" and "
+        "\"buckets\", an object counting values up to each bound.\n"
+        "\nExamples:\n" +
+        HelpExampleCli("gethivestats", "") +
+        HelpExampleRpc("gethivestats", ""));
+
+  const std::vector<CHiveCheckRound> rounds = GetHiveCheckRounds();
+  std::vector<double> tipToStart, getBCTs, binning, hashing, submit,
+      beesPerSecond;
+  std::map<std::string, int> results;
+  for (const CHiveCheckRound &round : rounds) {
+    if (round.nTipToStartMicros >= 0)
+      tipToStart.push_back(round.nTipToStartMicros * 0.001);
+    if (round.nGetBCTsMicros >= 0)
+      getBCTs.push_back(round.nGetBCTsMicros * 0.001);
+    if (round.nBinningMicros >= 0)
+      binning.push_back(round.nBinningMicros * 0.001);
+    if (round.nHashingMicros >= 0)
+      hashing.push_back(round.nHashingMicros * 0.001);
+    if (round.nSubmitMicros >= 0)
+      submit.push_back(round.nSubmitMicros * 0.001);
+    if (round.nBeesChecked > 0)
+      beesPerSecond.push_back(round.BeesPerSecondPerThread());
+    results[round.result]++;
+  }
+
+  const std::vector<double> msBounds = HiveHistogramBounds(0.1, 5000);
+  const std::vector<double> rateBounds = HiveHistogramBounds(1000, 10000000);
+
+  UniValue obj(UniValue::VOBJ);
+  obj.push_back(Pair("rounds", (int)rounds.size()));
+  obj.push_back(Pair("window", (int)HIVE_STATS_ROUNDS));
+  UniValue resultsObj(UniValue::VOBJ);
+  for (const auto &result : results)
+    resultsObj.push_back(Pair(result.first, result.second));
+  obj.push_back(Pair("results", resultsObj));
+  obj.push_back(Pair("tip_to_start_ms", HiveHistogram(tipToStart, msBounds)));
+  obj.push_back(Pair("getbcts_ms", HiveHistogram(getBCTs, msBounds)));
+  obj.push_back(Pair("binning_ms", HiveHistogram(binning, msBounds)));
+  obj.push_back(Pair("hashing_ms", HiveHistogram(hashing, msBounds)));
+  obj.push_back(
+      Pair("solution_to_submit_ms", HiveHistogram(submit, msBounds)));
+  obj.push_back(Pair("bees_per_sec_per_thread",
+                     HiveHistogram(beesPerSecond, rateBounds)));
+
+  if (!rounds.empty()) {
+    const CHiveCheckRound &round = rounds.back();
+    UniValue last(UniValue::VOBJ);
+    last.push_back(Pair("time", round.nTime));
+    last.push_back(Pair("height", round.nHeight));
+    last.push_back(Pair("result", round.result));
+    auto pushMillis = [&last](const std::string &name, int64_t micros) {
+      if (micros >= 0)
+        last.push_back(Pair(name, micros * 0.001));
+    };
+    pushMillis("tip_to_start_ms", round.nTipToStartMicros);
+    pushMillis("getbcts_ms", round.nGetBCTsMicros);
+    pushMillis("binning_ms", round.nBinningMicros);
+    pushMillis("hashing_ms", round.nHashingMicros);
+    pushMillis("solution_to_submit_ms", round.nSubmitMicros);
+    last.push_back(Pair("threads", round.nThreads));
+    last.push_back(Pair("bees", round.nBees));
+    last.push_back(Pair("bees_checked", round.nBeesChecked));
+    last.push_back(
+        Pair("bees_per_sec_per_thread", round.BeesPerSecondPerThread()));
+    obj.push_back(Pair("last", last));
+  }
+
+  return obj;
+}
+
 UniValue getnetworkhashps(const JSONRPCRequest &request) {
   if (request.fHelp || request.params.size() > 3)
     throw std::runtime_error(
@@ -241,7 +382,7 @@ UniValue generateBlocks(std::shared_ptr<CReserveScript> coinbaseScript,
       IncrementExtraNonce(pblock, chainActive.Tip(), nExtraNonce);
     }
     while (nMaxTries > 0 && pblock->nNonce < nInnerLoopCount &&
-           !CheckProofOfWork(pblock->GetPoWHash(), pblock->nBits,
+           !CheckProofOfWork(pblock->ComputePoWHash(), pblock->nBits,
                              Params().GetConsensus())) {
       ++pblock->nNonce;
       --nMaxTries;
@@ -1256,6 +1397,7 @@ static const CRPCCommand commands[] = {
      {"hivecheckdelay", "hivecheckthreads", "hiveearlyout"}},
 
     {"mining", "gethiveparams", &gethiveparams, {}},
+    {"mining", "gethivestats", &gethivestats, {}},
 
 };
 
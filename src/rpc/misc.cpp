@@ -14,6 +14,7 @@
 #include <netbase.h>
 #include <rpc/blockchain.h>
 #include <rpc/server.h>
+#include <rialto.h>
 #include <rpc/util.h>
 #include <timedata.h>
 #include <util.h>
@@ -517,6 +518,27 @@ static UniValue RPCLockedMemoryInfo() {
   return obj;
 }
 
+static UniValue
+RPCRialtoWhitePagesInfo(const std::unique_ptr<CRialtoWhitePagesDB> &db) {
+  UniValue obj(UniValue::VOBJ);
+  if (!db)
+    return obj;
+  CRialtoWhitePagesCacheStats stats = db->GetCacheStats();
+  obj.push_back(Pair("cached", uint64_t(stats.nCached)));
+  obj.push_back(Pair("hits", stats.nHits));
+  obj.push_back(Pair("misses", stats.nMisses));
+  obj.push_back(Pair("filtered", stats.nFiltered));
+  return obj;
+}
+
+static UniValue RPCRialtoMemoryInfo() {
+  UniValue obj(UniValue::VOBJ);
+  obj.push_back(Pair("whitepages", RPCRialtoWhitePagesInfo(pwhitepages)));
+  obj.push_back(Pair("mynicks", RPCRialtoWhitePagesInfo(pmynicks)));
+  obj.push_back(Pair("blockednicks", RPCRialtoWhitePagesInfo(pblockednicks)));
+  return obj;
+}
+
 #ifdef HAVE_MALLOC_INFO
 static std::string RPCMallocInfo() {
   char *ptr = nullptr;
@@ -561,6 +583,21 @@ UniValue getmemoryinfo(const JSONRPCRequest &request) {
         "pages failed at some point and key data could be swapped to disk.\n"
         "    \"chunks_used\": xxxxx,   (numeric) Number allocated chunks\n"
         "    \"chunks_free\": xxxxx,   (numeric) Number unused chunks\n"
+        "  },\n"
+        "  \"rialto\": {               (json object) Rialto white pages "
+        "lookup caches\n"
+        "    \"whitepages\": {         (json object) Global white pages; "
+        "\"mynicks\" and \"blockednicks\" have the same fields\n"
+        "      \"cached\": xxxxx,      (numeric) Nicks held in the LRU "
+        "cache\n"
+        "      \"hits\": xxxxx,        (numeric) Lookups answered from the "
+        "cache\n"
+        "      \"misses\": xxxxx,      (numeric) Lookups that read the "
+        "database\n"
+        "      \"filtered\": xxxxx,    (numeric) Lookups for unknown nicks "
+        "rejected by the bloom filter\n"
+        "    },\n"
+        "    ...\n"
         "  }\n"
         "}\n"
         "\nResult (mode \"mallocinfo\"):\n"
@@ -574,6 +611,7 @@ UniValue getmemoryinfo(const JSONRPCRequest &request) {
   if (mode == "stats") {
     UniValue obj(UniValue::VOBJ);
     obj.push_back(Pair("locked", RPCLockedMemoryInfo()));
+    obj.push_back(Pair("rialto", RPCRialtoMemoryInfo()));
     return obj;
   } else if (mode == "mallocinfo") {
 #ifdef HAVE_MALLOC_INFO
@@ -115,6 +115,14 @@ UniValue getpeerinfo(const JSONRPCRequest &request) {
         "we're currently asking from this peer\n"
         "       ...\n"
         "    ],\n"
+        "    \"rialto\": {               (object) Inbound Rialto messages from "
+        "this peer\n"
+        "       \"queued\": n,            (numeric) Awaiting verification\n"
+        "       \"accepted\": n,          (numeric) Verified and relayed\n"
+        "       \"rejected\": n,          (numeric) Failed verification\n"
+        "       \"dropped\": n            (numeric) Dropped by rate or queue "
+        "limits\n"
+        "    },\n"
         "    \"whitelisted\": true|false, (boolean) Whether the peer is "
         "whitelisted\n"
         "    \"bytessent_per_msg\": {\n"
@@ -182,6 +190,12 @@ UniValue getpeerinfo(const JSONRPCRequest &request) {
         heights.push_back(height);
       }
       obj.push_back(Pair("inflight", heights));
+      UniValue rialto(UniValue::VOBJ);
+      rialto.push_back(Pair("queued", statestats.nRialtoQueued));
+      rialto.push_back(Pair("accepted", statestats.nRialtoAccepted));
+      rialto.push_back(Pair("rejected", statestats.nRialtoRejected));
+      rialto.push_back(Pair("dropped", statestats.nRialtoDropped));
+      obj.push_back(Pair("rialto", rialto));
     }
     obj.push_back(Pair("whitelisted", stats.fWhitelisted));
 
@@ -9,6 +9,7 @@
 #include <net.h>
 #include <net_processing.h>
 #include <pow.h>
+#include <rialto.h>
 #include <script/sign.h>
 #include <serialize.h>
 #include <util.h>
@@ -285,6 +286,114 @@ CTransactionRef RandomOrphan() {
   return it->second.tx;
 }
 
+BOOST_AUTO_TEST_CASE(rialto_peer_limits) {
+  int64_t nNow = 1000000;
+  int64_t nLastRialtoTime = 0;
+  int nRialtoCount = 0;
+
+  for (int i = 0; i < MAX_RIALTO_MESSAGES_PER_MINUTE; i++)
+    BOOST_CHECK(
+        RialtoAdmitMessage(nNow + i / 4, nLastRialtoTime, nRialtoCount, 0));
+  BOOST_CHECK(!RialtoAdmitMessage(nNow + 59, nLastRialtoTime, nRialtoCount, 0));
+  BOOST_CHECK(!RialtoAdmitMessage(nNow + 60, nLastRialtoTime, nRialtoCount, 0));
+
+  BOOST_CHECK(RialtoAdmitMessage(nNow + 61, nLastRialtoTime, nRialtoCount, 0));
+  BOOST_CHECK_EQUAL(nLastRialtoTime, nNow + 61);
+  BOOST_CHECK_EQUAL(nRialtoCount, 1);
+
+  BOOST_CHECK(RialtoAdmitMessage(nNow + 62, nLastRialtoTime, nRialtoCount,
+                                 MAX_RIALTO_QUEUED_PER_PEER - 1));
+  BOOST_CHECK(!RialtoAdmitMessage(nNow + 62, nLastRialtoTime, nRialtoCount,
+                                  MAX_RIALTO_QUEUED_PER_PEER));
+  BOOST_CHECK_EQUAL(nRialtoCount, 3);
+}
+
+BOOST_AUTO_TEST_CASE(rialto_verify_queue) {
+  CRialtoVerifyQueue queue(3);
+  std::string message = "message";
+  uint256 hash = GetRandHash();
+  BOOST_CHECK_EQUAL(queue.Push(0, hash, message), CRialtoVerifyQueue::FULL);
+
+  queue.Start(nullptr, 0);
+  std::vector<uint256> hashes;
+  for (int i = 0; i < 3; i++) {
+    hashes.push_back(GetRandHash());
+    std::string message = "message" + std::to_string(i);
+    BOOST_CHECK_EQUAL(queue.Push(i, hashes[i], message),
+                      CRialtoVerifyQueue::QUEUED);
+    BOOST_CHECK(message.empty());
+  }
+  BOOST_CHECK_EQUAL(queue.Push(0, hash, message), CRialtoVerifyQueue::FULL);
+  BOOST_CHECK_EQUAL(message, "message");
+
+  std::vector<CRialtoVerifyItem> items;
+  BOOST_CHECK(queue.Pop(items, 1));
+  BOOST_REQUIRE_EQUAL(items.size(), 1U);
+  const CRialtoVerifyItem item = items[0];
+  BOOST_CHECK(item.hash == hashes[0]);
+  BOOST_CHECK_EQUAL(item.nodeid, 0);
+  BOOST_CHECK_EQUAL(item.message, "message0");
+
+  BOOST_CHECK_EQUAL(queue.Push(1, hashes[0], message),
+                    CRialtoVerifyQueue::DUPLICATE);
+  BOOST_CHECK_EQUAL(queue.Push(1, hashes[1], message),
+                    CRialtoVerifyQueue::DUPLICATE);
+  BOOST_CHECK_EQUAL(message, "message");
+  queue.Done(item.hash);
+  BOOST_CHECK_EQUAL(queue.Push(1, hashes[0], message),
+                    CRialtoVerifyQueue::QUEUED);
+  BOOST_CHECK_EQUAL(queue.Push(1, hash, message), CRialtoVerifyQueue::FULL);
+
+  BOOST_CHECK(queue.Pop(items));
+  BOOST_REQUIRE_EQUAL(items.size(), 3U);
+  BOOST_CHECK(items[0].hash == hashes[1]);
+  BOOST_CHECK(items[1].hash == hashes[2]);
+  BOOST_CHECK(items[2].hash == hashes[0]);
+
+  queue.Stop();
+  BOOST_CHECK_EQUAL(queue.Push(1, hash, message), CRialtoVerifyQueue::FULL);
+  BOOST_CHECK(!queue.Pop(items));
+}
+
+static void CheckRialtoMessagePenalised(const std::string &invalidMessage,
+                                        PeerLogicValidation &peerLogic) {
+  CAddress addr1(ip(0xa0b0c001), NODE_NONE);
+  CNode dummyNode1(id++, NODE_NETWORK, 0, INVALID_SOCKET, addr1, 0, 0,
+                   CAddress(), "", true);
+  peerLogic.InitializeNode(&dummyNode1);
+
+  CRialtoVerifyQueue queue;
+  queue.Start(nullptr, 1);
+  std::string message = invalidMessage;
+  BOOST_CHECK_EQUAL(queue.Push(dummyNode1.GetId(), GetRandHash(), message),
+                    CRialtoVerifyQueue::QUEUED);
+
+  CNodeStateStats stats;
+  for (int i = 0; i < 1000; i++) {
+    BOOST_CHECK(GetNodeStateStats(dummyNode1.GetId(), stats));
+    if (stats.nRialtoRejected)
+      break;
+    MilliSleep(10);
+  }
+  queue.Stop();
+  BOOST_CHECK_EQUAL(stats.nRialtoRejected, 1U);
+  BOOST_CHECK_EQUAL(stats.nRialtoAccepted, 0U);
+  BOOST_CHECK_EQUAL(stats.nMisbehavior, 20);
+
+  bool dummy;
+  peerLogic.FinalizeNode(dummyNode1.GetId(), dummy);
+}
+
+BOOST_AUTO_TEST_CASE(rialto_invalid_message_penalised) {
+  CheckRialtoMessagePenalised("not a rialto message", *peerLogic);
+}
+
+BOOST_AUTO_TEST_CASE(rialto_non_hex_message_penalised) {
+  // Long enough to reach the nonce and timestamp parsing.
+  CheckRialtoMessagePenalised(std::string(RIALTO_L3_MAX_LENGTH * 2, 'z'),
+                              *peerLogic);
+}
+
 BOOST_AUTO_TEST_CASE(DoS_mapOrphans) {
   CKey key;
   key.MakeNewKey(true);
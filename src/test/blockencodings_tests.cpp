@@ -47,7 +47,7 @@ static CBlock BuildBlockTestCase() {
   bool mutated;
   block.hashMerkleRoot = BlockMerkleRoot(block, &mutated);
   assert(!mutated);
-  while (!CheckProofOfWork(block.GetPoWHash(), block.nBits,
+  while (!CheckProofOfWork(block.ComputePoWHash(), block.nBits,
                            Params().GetConsensus()))
     ++block.nNonce;
   return block;
@@ -311,7 +311,7 @@ BOOST_AUTO_TEST_CASE(EmptyBlockRoundTripTest) {
   bool mutated;
   block.hashMerkleRoot = BlockMerkleRoot(block, &mutated);
   assert(!mutated);
-  while (!CheckProofOfWork(block.GetPoWHash(), block.nBits,
+  while (!CheckProofOfWork(block.ComputePoWHash(), block.nBits,
                            Params().GetConsensus()))
     ++block.nNonce;
 
@@ -10,6 +10,7 @@
 #include <crypto/sha1.h>
 #include <crypto/sha256.h>
 #include <crypto/sha512.h>
+#include <hash.h>
 #include <random.h>
 #include <test/test_bitcoin.h>
 #include <utilstrencodings.h>
@@ -653,4 +654,45 @@ BOOST_AUTO_TEST_CASE(countbits_tests) {
   }
 }
 
+BOOST_AUTO_TEST_CASE(sha256d64) {
+  for (int i = 0; i <= 32; ++i) {
+    unsigned char in[64 * 32];
+    unsigned char out1[32 * 32], out2[32 * 32];
+    for (int j = 0; j < 64 * i; ++j) {
+      in[j] = InsecureRandBits(8);
+    }
+    for (int j = 0; j < i; ++j) {
+      CHash256().Write(in + 64 * j, 64).Finalize(out1 + 32 * j);
+    }
+    SHA256D64(out2, in, i);
+    BOOST_CHECK(memcmp(out1, out2, 32 * i) == 0);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(sha256_finalize_double_batch) {
+  unsigned char prefix[130], tails[32 * 19];
+  unsigned char out1[32 * 19], out2[32 * 19];
+  for (size_t i = 0; i < sizeof(prefix); ++i)
+    prefix[i] = InsecureRandBits(8);
+  for (size_t i = 0; i < sizeof(tails); ++i)
+    tails[i] = InsecureRandBits(8);
+
+  for (size_t prefixLen = 0; prefixLen <= sizeof(prefix); prefixLen += 3) {
+    CSHA256 sha;
+    sha.Write(prefix, prefixLen);
+    for (size_t tailLen : {0, 4, 32}) {
+      for (size_t count = 0; count <= 19; count += 6) {
+        for (size_t j = 0; j < count; ++j) {
+          CHash256()
+              .Write(prefix, prefixLen)
+              .Write(tails + j * tailLen, tailLen)
+              .Finalize(out1 + 32 * j);
+        }
+        sha.FinalizeDoubleBatch(tails, tailLen, count, out2);
+        BOOST_CHECK(memcmp(out1, out2, 32 * count) == 0);
+      }
+    }
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -4,6 +4,7 @@
 
 #include <dbwrapper.h>
 #include <random.h>
+#include <rialto.h>
 #include <test/test_bitcoin.h>
 #include <uint256.h>
 
@@ -291,4 +292,37 @@ BOOST_AUTO_TEST_CASE(iterator_string_ordering) {
   }
 }
 
+BOOST_FIXTURE_TEST_CASE(rialto_whitepages_cache, TestingSetup) {
+  CRialtoWhitePagesDB db("test_whitepages", (1 << 20), true, true);
+  std::string pubKey;
+
+  BOOST_CHECK(!db.NickExists("alice"));
+  CRialtoWhitePagesCacheStats stats = db.GetCacheStats();
+  BOOST_CHECK_EQUAL(stats.nFiltered, 1U);
+  BOOST_CHECK_EQUAL(stats.nMisses, 0U);
+
+  BOOST_CHECK(db.SetPubKeyForNick("alice", "02aa"));
+  BOOST_CHECK(db.GetPubKeyForNick("alice", pubKey));
+  BOOST_CHECK_EQUAL(pubKey, "02aa");
+  stats = db.GetCacheStats();
+  BOOST_CHECK_EQUAL(stats.nHits, 1U);
+  BOOST_CHECK_EQUAL(stats.nCached, 1U);
+
+  BOOST_CHECK(db.RemoveNick("alice"));
+  BOOST_CHECK(!db.NickExists("alice"));
+  BOOST_CHECK_EQUAL(db.GetCacheStats().nMisses, 1U);
+
+  std::map<std::string, std::string> nicks;
+  nicks["bob"] = "03bb";
+  BOOST_CHECK(db.SetPubKeyForNick("carol", "02cc"));
+  BOOST_CHECK(db.ReplaceAll(nicks));
+  BOOST_CHECK_EQUAL(db.GetCacheStats().nCached, 0U);
+  BOOST_CHECK(!db.NickExists("carol"));
+  BOOST_CHECK(db.GetPubKeyForNick("bob", pubKey));
+  BOOST_CHECK_EQUAL(pubKey, "03bb");
+  BOOST_CHECK(db.NickExists("bob"));
+  stats = db.GetCacheStats();
+  BOOST_CHECK_EQUAL(stats.nHits, 2U);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,61 @@
+// Copyright (c) 2019-2021 The Litecoin Cash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_TEST_MIXED_CHAIN_H
+#define BITCOIN_TEST_MIXED_CHAIN_H
+
+#include <base58.h>
+#include <chain.h>
+#include <chainparams.h>
+#include <primitives/block.h>
+#include <pubkey.h>
+#include <random.h>
+
+#include <vector>
+
+// Synthetic chains for retarget tests and benches mix every PoW type with
+// hive blocks, with the hive and MinotaurX rules in force from the start.
+static inline Consensus::Params MixedChainParams() {
+  Consensus::Params params =
+      CreateChainParams(CBaseChainParams::MAIN)->GetConsensus();
+  params.minHiveCheckBlock = 0;
+  params.lastScryptBlock = 0;
+  params.vDeployments[Consensus::DEPLOYMENT_HIVE_1_1].nStartTime =
+      Consensus::BIP9Deployment::ALWAYS_ACTIVE;
+  params.vDeployments[Consensus::DEPLOYMENT_MINOTAURX].nStartTime =
+      Consensus::BIP9Deployment::ALWAYS_ACTIVE;
+  return params;
+}
+
+// Hive proof and bee population checks also need hive enabled and hive
+// addresses that decode under the selected chain, which is regtest for the
+// unit tests and has none of its own.
+static inline Consensus::Params HiveChainParams() {
+  Consensus::Params params = MixedChainParams();
+  params.vDeployments[Consensus::DEPLOYMENT_HIVE].nStartTime =
+      Consensus::BIP9Deployment::ALWAYS_ACTIVE;
+  params.beeCreationAddress = EncodeDestination(
+      CKeyID(uint160(std::vector<unsigned char>(20, 0xbc))));
+  params.hiveCommunityAddress = EncodeDestination(
+      CKeyID(uint160(std::vector<unsigned char>(20, 0xcf))));
+  return params;
+}
+
+static inline void MakeMixedBlockIndex(CBlockIndex &block, CBlockIndex *pprev,
+                                       int64_t nTime, FastRandomContext &rng,
+                                       const Consensus::Params &params,
+                                       bool fLegacy = false) {
+  block.pprev = pprev;
+  block.nHeight = pprev ? pprev->nHeight + 1 : 0;
+  block.nTime = nTime;
+  block.nBits = 0x1c00ffff - rng.randrange(0x1000);
+  block.nNonce = rng.randrange(4) == 0 ? params.hiveNonceMarker
+                                       : params.hiveNonceMarker + 1;
+  block.nVersion =
+      fLegacy ? 0x20000000 : (int)rng.randrange(NUM_BLOCK_TYPES) << 16;
+  block.BuildSkip();
+  block.BuildPrevSameKind(params);
+}
+
+#endif
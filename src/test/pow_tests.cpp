@@ -2,15 +2,31 @@
 // Distributed under the MIT/X11 software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <base58.h>
 #include <chain.h>
 #include <chainparams.h>
+#include <clientversion.h>
+#include <coins.h>
+#include <consensus/merkle.h>
+#include <crypto/common.h>
+#include <crypto/minotaurx/minotaur.h>
+#include <crypto/scrypt.h>
+#include <hash.h>
+#include <key.h>
 #include <pow.h>
 #include <random.h>
+#include <script/standard.h>
+#include <streams.h>
+#include <test/mixed_chain.h>
 #include <test/test_bitcoin.h>
+#include <txdb.h>
 #include <util.h>
+#include <validation.h>
 
 #include <boost/test/unit_test.hpp>
 
+extern BeePopGraphPoint beePopGraph[1024 * 40];
+
 BOOST_FIXTURE_TEST_SUITE(pow_tests, BasicTestingSetup)
 
 BOOST_AUTO_TEST_CASE(get_next_work) {
@@ -95,4 +111,712 @@ BOOST_AUTO_TEST_CASE(GetBlockProofEquivalentTime_test) {
   }
 }
 
+BOOST_AUTO_TEST_CASE(minotaur_hasher_known_answers) {
+  const std::string inputs[] = {"", "abc",
+                                "The quick brown fox jumps over the lazy dog"};
+  const std::string expected[] = {
+      "2cd7229216375a090f0385569da9ff8fdb99c08d5cb22424e3d67d73e6392052",
+      "c59abd333507a37cd9303b1acf4e6cc5770dc66ed6d871ed9c76bfbd0d0b3947",
+      "f9814b81d901536630be3541427bebd14f81dc636c5c036431c2a548583e9e29"};
+  const std::string expectedX[] = {
+      "5e442141e8aef7f5ac3dc4d43662288a0fdaa47dbb4dbc2d88f07a9575ca8c5f",
+      "524d63fd8e5de7735734fca943eff6fc8a3de168e06502e0fd487003999dc72f",
+      "347209b821407c35b0fe6b159d40c1b10aaf6f804727e7b3d5a07d1ae62706a9"};
+
+  MinotaurHasher hasher;
+  for (int round = 0; round < 2; round++) {
+    for (int i = 0; i < 3; i++) {
+      const uint8_t *data = (const uint8_t *)inputs[i].data();
+      BOOST_CHECK_EQUAL(hasher.Hash(data, inputs[i].size()).ToString(),
+                        expected[i]);
+      BOOST_CHECK_EQUAL(hasher.Hash(data, inputs[i].size(), true).ToString(),
+                        expectedX[i]);
+      BOOST_CHECK_EQUAL(
+          Minotaur(inputs[i].begin(), inputs[i].end(), true).ToString(),
+          expectedX[i]);
+    }
+  }
+
+  unsigned char header[80];
+  for (int i = 0; i < 80; i++)
+    header[i] = i;
+  BOOST_CHECK_EQUAL(
+      Minotaur(header, header + 80, true).ToString(),
+      "8aeb380b005e80e330b0d4e66ed27856dcd0017fdca02b6dfa70d78234098048");
+}
+
+BOOST_FIXTURE_TEST_CASE(minotaur_batch_verify, TestingSetup) {
+  std::vector<std::vector<unsigned char>> data;
+  std::vector<CMinotaurVerifyInput> inputs;
+  std::vector<arith_uint256> targets;
+  for (int i = 0; i < 40; i++)
+    data.push_back(ParseHex(GetRandHash().GetHex()));
+  for (int i = 0; i < 40; i++) {
+    bool minotaurX = i % 10 == 0;
+    inputs.push_back({data[i].data(), data[i].size(), minotaurX});
+    arith_uint256 hash =
+        UintToArith256(Minotaur(data[i].begin(), data[i].end(), minotaurX));
+    targets.push_back(i % 3 ? hash : hash - 1);
+  }
+
+  std::vector<bool> valid = MinotaurBatchVerify(inputs, targets);
+  BOOST_CHECK_EQUAL(valid.size(), inputs.size());
+  for (int i = 0; i < 40; i++)
+    BOOST_CHECK_EQUAL(valid[i], i % 3 != 0);
+  BOOST_CHECK(MinotaurBatchVerify({}, {}).empty());
+}
+
+BOOST_AUTO_TEST_CASE(headers_batch_verify) {
+  const Consensus::Params &params = Params().GetConsensus();
+  arith_uint256 shaLimit = UintToArith256(params.powTypeLimits[0]);
+  arith_uint256 minotaurLimit = UintToArith256(params.powTypeLimits[1]);
+  BOOST_CHECK(GetPoWLimit(params) == minotaurLimit);
+
+  CBlockHeader scrypt;
+  scrypt.nTime = params.powForkTime;
+  BOOST_CHECK(GetPoWLimit(scrypt, params) == UintToArith256(params.powLimit));
+
+  CBlockHeader sha;
+  sha.nVersion = 0x20000000;
+  sha.nTime = params.powForkTime + 1;
+  sha.nBits = minotaurLimit.GetCompact();
+  while (!CheckProofOfWork(sha.ComputePoWHash(), sha.nBits, params))
+    sha.nNonce++;
+  BOOST_CHECK(GetPoWLimit(sha, params) == shaLimit);
+
+  CBlockHeader minotaur;
+  minotaur.nVersion = POW_TYPE_MINOTAURX << 16;
+  minotaur.nTime = params.powForkTime + 1;
+  minotaur.nBits = minotaurLimit.GetCompact();
+  while (!CheckProofOfWork(minotaur.ComputePoWHash(), minotaur.nBits,
+                           params))
+    minotaur.nNonce++;
+  BOOST_CHECK(GetPoWLimit(minotaur, params) == minotaurLimit);
+
+  CBlockHeader unknown = minotaur;
+  unknown.nVersion = NUM_BLOCK_TYPES << 16;
+  BOOST_CHECK(GetPoWLimit(unknown, params) == 0);
+
+  std::vector<CBlockHeader> headers;
+  headers.push_back(minotaur);
+  headers.push_back(sha);
+  headers.push_back(minotaur);
+  headers.back().nNonce++;
+  while (CheckProofOfWork(headers.back().ComputePoWHash(), headers.back().nBits,
+                          params))
+    headers.back().nNonce++;
+  for (unsigned int nBits : {0x00000000U, 0x01800000U, 0xff123456U}) {
+    headers.push_back(minotaur);
+    headers.back().nBits = nBits;
+  }
+
+  std::vector<bool> valid = HeadersBatchVerify(headers, params);
+  BOOST_CHECK_EQUAL(valid.size(), headers.size());
+  BOOST_CHECK(valid[0]);
+  for (size_t i = 1; i < headers.size(); i++)
+    BOOST_CHECK(!valid[i]);
+  for (size_t i = 0; i < headers.size(); i++)
+    if (valid[i])
+      BOOST_CHECK(CheckProofOfWork(headers[i].GetPoWHash(), headers[i].nBits,
+                                   params));
+  BOOST_CHECK(HeadersBatchVerify({}, params).empty());
+}
+
+BOOST_AUTO_TEST_CASE(bee_hasher_matches_reference) {
+  const std::string detRand = GetRandHash().GetHex() + GetRandHash().GetHex();
+  const std::string txid = GetRandHash().GetHex();
+  CBeeHasher sha256Hasher(detRand, txid, false);
+  CBeeHasher minotaurHasher(detRand, txid, true);
+  MinotaurHasher engine;
+  CBeeHasher engineHasher(detRand, txid, true, &engine);
+
+  const uint32_t nonces[] = {0, 1, 9, 10, 99, 1000, 123456, 2147483647};
+  for (uint32_t beeNonce : nonces) {
+    arith_uint256 expected(
+        (CHashWriter(SER_GETHASH, 0) << detRand << txid << (int)beeNonce)
+            .GetHash()
+            .GetHex());
+    BOOST_CHECK(sha256Hasher.GetHash(beeNonce) == expected);
+
+    std::stringstream buf;
+    buf << detRand << txid << beeNonce;
+    arith_uint256 expectedMinotaur(
+        CBlockHeader::MinotaurHashString(buf.str()).ToString());
+    BOOST_CHECK(minotaurHasher.GetHash(beeNonce) == expectedMinotaur);
+    BOOST_CHECK(engineHasher.GetHash(beeNonce) == expectedMinotaur);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(bee_hasher_batch_matches_single) {
+  const std::string txid = GetRandHash().GetHex();
+  std::string detRand;
+  for (int len = 0; len < 70; len++, detRand += 'a' + len % 16) {
+    CBeeHasher sha256Hasher(detRand, txid, false);
+    arith_uint256 hashes[19];
+    sha256Hasher.GetHashes(1000 - len, 19, hashes);
+    for (int i = 0; i < 19; i++)
+      BOOST_CHECK(hashes[i] == sha256Hasher.GetHash(1000 - len + i));
+  }
+
+  CBeeHasher minotaurHasher(detRand, txid, true);
+  arith_uint256 hashes[3];
+  minotaurHasher.GetHashes(42, 3, hashes);
+  for (int i = 0; i < 3; i++)
+    BOOST_CHECK(hashes[i] == minotaurHasher.GetHash(42 + i));
+}
+
+BOOST_AUTO_TEST_CASE(pow_hash_memoised) {
+  const Consensus::Params &params = Params().GetConsensus();
+  CBlockHeader header;
+  header.nVersion = 2;
+  header.hashMerkleRoot = GetRandHash();
+  header.nTime = params.powForkTime - 1;
+  header.nBits = 0x1e0ffff0;
+
+  for (int i = 0; i < 2; i++) {
+    header.nNonce = i;
+    uint256 expected;
+    scrypt_1024_1_1_256(BEGIN(header.nVersion), BEGIN(expected));
+    BOOST_CHECK(header.GetPoWHash() == expected);
+    BOOST_CHECK(header.GetPoWHash() == expected);
+    BOOST_CHECK(header.ComputePoWHash() == expected);
+  }
+
+  std::vector<CBlockHeader> headers(5, header);
+  for (size_t i = 0; i < headers.size(); i++)
+    headers[i].nNonce = i;
+  std::vector<uint256> hashes(headers.size());
+  CBlockHeader::GetScryptPoWHashes(headers.data(), headers.size(),
+                                   hashes.data());
+  for (size_t i = 0; i < headers.size(); i++)
+    BOOST_CHECK(hashes[i] == headers[i].ComputePoWHash());
+
+  header.nTime = params.powForkTime + 1;
+  header.nVersion = POW_TYPE_MINOTAURX << 16;
+  uint256 minotaurHash = Minotaur(BEGIN(header.nVersion), END(header.nNonce), true);
+  BOOST_CHECK(header.GetPoWHash() == minotaurHash);
+  BOOST_CHECK(header.GetPoWHash() == minotaurHash);
+
+  CBlockIndex index(header);
+  uint256 blockHash = header.GetHash();
+  index.phashBlock = &blockHash;
+  BOOST_CHECK(index.GetBlockPoWHash() == minotaurHash);
+
+  header.nVersion = 0x20000000;
+  BOOST_CHECK(header.GetPoWHash() == header.GetHash());
+}
+
+BOOST_AUTO_TEST_CASE(lwma_same_kind_links) {
+  const Consensus::Params params = MixedChainParams();
+  ResetDifficultyCache();
+
+  const int legacyBlocks = 200;
+  std::vector<CBlockIndex> blocks(600);
+  for (size_t i = 0; i < blocks.size(); i++)
+    MakeMixedBlockIndex(blocks[i], i ? &blocks[i - 1] : nullptr,
+                        1600000000 + i * 150 + InsecureRandRange(120),
+                        insecure_rand_ctx, params, (int)i < legacyBlocks);
+
+  for (size_t i = 1; i < blocks.size(); i++) {
+    const CBlockIndex &block = blocks[i];
+    const bool fHive = block.IsHiveMined(params);
+    const bool fLegacy = (int)i < legacyBlocks;
+    const CBlockIndex *pexpected = nullptr;
+    for (const CBlockIndex *pindex = block.pprev; pindex;
+         pindex = pindex->pprev) {
+      const bool fPrevHive = pindex->IsHiveMined(params);
+      const bool fPrevLegacy = pindex->nHeight < legacyBlocks;
+      if (fHive ? fPrevHive
+                : !fPrevHive && fPrevLegacy == fLegacy &&
+                      (fLegacy || pindex->GetPoWType() == block.GetPoWType())) {
+        pexpected = pindex;
+        break;
+      }
+      if (!fHive && !fPrevHive && fPrevLegacy != fLegacy)
+        break;
+    }
+    BOOST_CHECK(block.pprevSameKind == pexpected);
+  }
+
+  CBlockHeader header;
+  header.nTime = blocks.back().nTime + 150;
+  std::vector<unsigned int> linked, unlinked;
+  for (size_t tip = 300; tip < blocks.size(); tip += 50)
+    for (int powType = 0; powType < NUM_BLOCK_TYPES; powType++)
+      linked.push_back(GetNextWorkRequiredLWMA(&blocks[tip], &header, params,
+                                               (POW_TYPE)powType));
+
+  for (CBlockIndex &block : blocks)
+    block.pprevSameKind = nullptr;
+  ResetDifficultyCache();
+  for (size_t tip = 300; tip < blocks.size(); tip += 50)
+    for (int powType = 0; powType < NUM_BLOCK_TYPES; powType++)
+      unlinked.push_back(GetNextWorkRequiredLWMA(&blocks[tip], &header, params,
+                                                 (POW_TYPE)powType));
+
+  BOOST_CHECK(linked == unlinked);
+  ResetDifficultyCache();
+}
+
+BOOST_AUTO_TEST_CASE(difficulty_cache_matches_rebuild) {
+  const Consensus::Params params = MixedChainParams();
+  ResetDifficultyCache();
+
+  const int mainBlocks = 1400, forkPoint = 1340;
+  std::vector<CBlockIndex> blocks(mainBlocks + 60);
+  int64_t nTime = 1600000000;
+  for (size_t i = 0; i < blocks.size(); i++) {
+    nTime += 75 + (InsecureRandRange(50) == 0 ? 5000 : 0);
+    MakeMixedBlockIndex(blocks[i],
+                        (int)i == mainBlocks ? &blocks[forkPoint]
+                                             : i ? &blocks[i - 1] : nullptr,
+                        nTime - InsecureRandRange(600), insecure_rand_ctx,
+                        params);
+  }
+
+  const int64_t T = params.nPowTargetSpacing * 2;
+  const int64_t N = params.lwmaAveragingWindow;
+  const int64_t k = N * (N + 1) * T / 2;
+  auto referenceLWMA = [&](const CBlockIndex *tip, POW_TYPE powType) {
+    const arith_uint256 powLimit =
+        UintToArith256(params.powTypeLimits[powType]);
+    std::vector<const CBlockIndex *> window;
+    for (const CBlockIndex *pindex = tip; (int64_t)window.size() < N;
+         pindex = pindex->pprev)
+      if (!pindex->IsHiveMined(params) && pindex->GetPoWType() == powType)
+        window.push_back(pindex);
+
+    arith_uint256 avgTarget;
+    int64_t previousTimestamp = window.back()->GetBlockTime();
+    int64_t sumWeightedSolvetimes = 0;
+    for (int64_t j = 1; j <= N; j++) {
+      const CBlockIndex *pindex = window[N - j];
+      const int64_t thisTimestamp =
+          std::max(pindex->GetBlockTime(), previousTimestamp + 1);
+      sumWeightedSolvetimes +=
+          std::min(6 * T, thisTimestamp - previousTimestamp) * j;
+      previousTimestamp = thisTimestamp;
+      arith_uint256 target;
+      target.SetCompact(pindex->nBits);
+      avgTarget += target / N / k;
+    }
+    const arith_uint256 nextTarget = avgTarget * sumWeightedSolvetimes;
+    return nextTarget > powLimit ? powLimit.GetCompact()
+                                 : nextTarget.GetCompact();
+  };
+  auto referenceHive = [&](const CBlockIndex *tip) {
+    const arith_uint256 powLimit = UintToArith256(params.powLimitHive);
+    arith_uint256 beeHashTarget;
+    int hiveBlockCount = 0;
+    const CBlockIndex *pindex = tip;
+    for (; hiveBlockCount < params.hiveDifficultyWindow; pindex = pindex->pprev)
+      if (pindex->IsHiveMined(params)) {
+        beeHashTarget += arith_uint256().SetCompact(pindex->nBits);
+        if (++hiveBlockCount == params.hiveDifficultyWindow)
+          break;
+      }
+    beeHashTarget /= hiveBlockCount;
+    beeHashTarget *= tip->nHeight - pindex->nHeight + 1;
+    beeHashTarget /= hiveBlockCount * params.hiveBlockSpacingTarget;
+    return beeHashTarget > powLimit ? powLimit.GetCompact()
+                                    : beeHashTarget.GetCompact();
+  };
+
+  std::vector<const CBlockIndex *> tips;
+  for (int i = 800; i < mainBlocks; i++)
+    tips.push_back(&blocks[i]);
+  for (size_t i = mainBlocks; i < blocks.size(); i++) {
+    tips.push_back(&blocks[i]);
+    tips.push_back(&blocks[forkPoint + 1 + (i - mainBlocks) % 59]);
+  }
+
+  CBlockHeader header;
+  for (const CBlockIndex *tip : tips) {
+    header.nTime = tip->nTime + 150;
+    for (int powType = 0; powType < NUM_BLOCK_TYPES; powType++)
+      BOOST_CHECK_EQUAL(
+          GetNextWorkRequiredLWMA(tip, &header, params, (POW_TYPE)powType),
+          referenceLWMA(tip, (POW_TYPE)powType));
+    BOOST_CHECK_EQUAL(GetNextHiveWorkRequired(tip, params), referenceHive(tip));
+  }
+
+  ResetDifficultyCache();
+}
+
+BOOST_FIXTURE_TEST_CASE(hive_proof_bct_index, TestingSetup) {
+  const Consensus::Params params = HiveChainParams();
+  ResetDifficultyCache();
+
+  const int bctHeight = 10;
+  std::vector<CBlockIndex> blocks(bctHeight + params.beeGestationBlocks + 40);
+  std::vector<uint256> hashes(blocks.size());
+  for (size_t i = 0; i < blocks.size(); i++) {
+    hashes[i] = InsecureRand256();
+    blocks[i].phashBlock = &hashes[i];
+    MakeMixedBlockIndex(blocks[i], i ? &blocks[i - 1] : nullptr,
+                        1600000000 + i * 150, insecure_rand_ctx, params);
+    blocks[i].nNonce = params.hiveNonceMarker + 1;
+  }
+  CBlockIndex *pindexPrev = &blocks.back();
+
+  CKey honeyKey;
+  honeyKey.MakeNewKey(true);
+  CScript scriptPubKeyHoney =
+      GetScriptForDestination(honeyKey.GetPubKey().GetID());
+
+  CMutableTransaction bct;
+  bct.vin.resize(1);
+  bct.vin[0].prevout = COutPoint(InsecureRand256(), 0);
+  bct.vout.resize(1);
+  bct.vout[0].scriptPubKey = GetScriptForDestination(
+      DecodeDestination(params.beeCreationAddress));
+  bct.vout[0].scriptPubKey << OP_RETURN << OP_BEE;
+  bct.vout[0].scriptPubKey += scriptPubKeyHoney;
+  bct.vout[0].nValue = GetBeeCost(bctHeight, params) * 1000;
+  const uint256 bctHash = bct.GetHash();
+  const std::string bctTxid = bctHash.GetHex();
+
+  const std::string detRandString = GetDeterministicRandString(pindexPrev);
+  arith_uint256 beeHashTarget;
+  beeHashTarget.SetCompact(GetNextHiveWorkRequired(pindexPrev, params));
+  uint32_t beeNonce = 0;
+  while (arith_uint256(CBlockHeader::MinotaurHashArbitrary(
+                           std::string(detRandString + bctTxid +
+                                       std::to_string(beeNonce))
+                               .c_str())
+                           .ToString()) >= beeHashTarget)
+    beeNonce++;
+  BOOST_REQUIRE(beeNonce < 1000);
+
+  unsigned char beeNonceEncoded[4], bctHeightEncoded[4];
+  WriteLE32(beeNonceEncoded, beeNonce);
+  WriteLE32(bctHeightEncoded, bctHeight);
+  std::vector<unsigned char> messageSig;
+  BOOST_REQUIRE(honeyKey.SignCompact(
+      (CHashWriter(SER_GETHASH, 0) << detRandString).GetHash(), messageSig));
+
+  CMutableTransaction coinbase;
+  coinbase.vin.resize(1);
+  coinbase.vin[0].prevout.SetNull();
+  coinbase.vout.resize(2);
+  coinbase.vout[0].scriptPubKey
+      << OP_RETURN << OP_BEE
+      << std::vector<unsigned char>(beeNonceEncoded, beeNonceEncoded + 4)
+      << std::vector<unsigned char>(bctHeightEncoded, bctHeightEncoded + 4)
+      << OP_FALSE << std::vector<unsigned char>(bctTxid.begin(), bctTxid.end())
+      << messageSig;
+  coinbase.vout[1].scriptPubKey = scriptPubKeyHoney;
+  CBlock block;
+  block.hashPrevBlock = pindexPrev->GetBlockHash();
+  block.vtx.push_back(MakeTransactionRef(std::move(coinbase)));
+
+  {
+    LOCK(cs_main);
+    mapBlockIndex[block.hashPrevBlock] = pindexPrev;
+  }
+
+  // Unspent, the BCT is found in the UTXO set.
+  const COutPoint outBeeCreation(bctHash, 0);
+  pcoinsTip->AddCoin(outBeeCreation, Coin(bct.vout[0], bctHeight, false),
+                     false);
+  BOOST_CHECK(CheckHiveProof(&block, params));
+
+  // Once spent, the record ConnectBlock wrote to the BCT index backs it.
+  pcoinsTip->SpendCoin(outBeeCreation);
+  CDiskBCTInfo info;
+  info.nHeight = bctHeight;
+  info.hashBlock = blocks[bctHeight].GetBlockHash();
+  info.beeFeeOut = bct.vout[0];
+  std::vector<std::pair<uint256, CDiskBCTInfo>> vInfo(
+      1, std::make_pair(bctHash, info));
+  BOOST_REQUIRE(pblocktree->WriteBCTIndex(vInfo));
+  BOOST_CHECK(GetIndexedBCT(bctHash, pindexPrev, info));
+  BOOST_CHECK(CheckHiveProof(&block, params));
+
+  // A record from a block off this chain is ignored and the check falls back
+  // to the deep drill, which has no block data to read here.
+  vInfo[0].second.hashBlock = InsecureRand256();
+  BOOST_REQUIRE(pblocktree->WriteBCTIndex(vInfo));
+  BOOST_CHECK(!GetIndexedBCT(bctHash, pindexPrev, info));
+  BOOST_CHECK_THROW(CheckHiveProof(&block, params), std::runtime_error);
+
+  // Pruning to a height erases the records at or below it, but not one
+  // replaced by the same BCT mined again higher up, nor one whose height
+  // would sort below the cutoff if it were stored little endian.
+  const uint256 otherHash = InsecureRand256();
+  const uint256 laterHash = InsecureRand256();
+  vInfo.emplace_back(otherHash, info);
+  BOOST_REQUIRE(pblocktree->WriteBCTIndex(vInfo));
+  vInfo.resize(1);
+  vInfo[0].second.nHeight = bctHeight + 1;
+  BOOST_REQUIRE(pblocktree->WriteBCTIndex(vInfo));
+  vInfo[0].first = laterHash;
+  vInfo[0].second.nHeight = bctHeight + 256;
+  BOOST_REQUIRE(pblocktree->WriteBCTIndex(vInfo));
+  BOOST_REQUIRE(pblocktree->EraseBCTIndexToHeight(bctHeight));
+  BOOST_CHECK(!pblocktree->ReadBCTIndex(otherHash, info));
+  BOOST_CHECK(pblocktree->ReadBCTIndex(bctHash, info));
+  BOOST_REQUIRE(pblocktree->EraseBCTIndexToHeight(bctHeight + 1));
+  BOOST_CHECK(!pblocktree->ReadBCTIndex(bctHash, info));
+  BOOST_CHECK(pblocktree->ReadBCTIndex(laterHash, info));
+  BOOST_REQUIRE(pblocktree->EraseBCTIndexToHeight(bctHeight + 256));
+  BOOST_CHECK(!pblocktree->ReadBCTIndex(laterHash, info));
+
+  {
+    LOCK(cs_main);
+    mapBlockIndex.erase(block.hashPrevBlock);
+  }
+  ResetDifficultyCache();
+}
+
+BOOST_FIXTURE_TEST_CASE(bee_pop_index_matches_walk, TestingSetup) {
+  Consensus::Params params = HiveChainParams();
+  params.beeGestationBlocks = 12;
+  params.beeLifespanBlocks = 36;
+  const int totalBeeLifespan =
+      params.beeGestationBlocks + params.beeLifespanBlocks;
+
+  const CScript scriptPubKeyBCF = GetScriptForDestination(
+      DecodeDestination(params.beeCreationAddress));
+  const CScript scriptPubKeyCF = GetScriptForDestination(
+      DecodeDestination(params.hiveCommunityAddress));
+  CScript scriptPubKeyBCT = scriptPubKeyBCF;
+  scriptPubKeyBCT << OP_RETURN << OP_BEE;
+  scriptPubKeyBCT +=
+      GetScriptForDestination(CKeyID(uint160(insecure_rand_ctx.randbytes(20))));
+
+  LOCK(cs_main);
+  CBlockIndex *pindexOldTip = chainActive.Tip();
+  std::map<CBlockIndex *, CBlock> blocks;
+  CDiskBlockPos pos(1, 0);
+  int64_t nTime = GetTime() - 200 * params.nPowTargetSpacing;
+
+  // Writes a block with a few BCTs, some paying the community fund correctly
+  // and some not, and connects it as ConnectBlock would.
+  auto connectBlock = [&](CBlockIndex *pindexPrev, bool fHive) {
+    CBlock block;
+    block.hashPrevBlock = pindexPrev->GetBlockHash();
+    block.nTime = nTime += params.nPowTargetSpacing;
+    block.nNonce = fHive ? params.hiveNonceMarker : params.hiveNonceMarker + 1;
+    const CAmount beeCost = GetBeeCost(pindexPrev->nHeight + 1, params);
+    for (int n = InsecureRandRange(3); n > 0; n--) {
+      CMutableTransaction bct;
+      bct.vin.resize(1);
+      bct.vin[0].prevout = COutPoint(InsecureRand256(), 0);
+      bct.vout.resize(1);
+      bct.vout[0].scriptPubKey = scriptPubKeyBCT;
+      bct.vout[0].nValue =
+          beeCost * (1 + InsecureRandRange(50)) + InsecureRandRange(beeCost);
+      if (InsecureRandBool()) {
+        const CAmount q = 2 * beeCost * (1 + InsecureRandRange(10));
+        const CAmount donation = q + (q >> 1) + InsecureRandRange(2);
+        bct.vout[0].nValue = q * params.communityContribFactor - donation;
+        bct.vout.emplace_back(donation, scriptPubKeyCF);
+      }
+      block.vtx.push_back(MakeTransactionRef(std::move(bct)));
+    }
+    block.hashMerkleRoot = BlockMerkleRoot(block);
+    {
+      CAutoFile fileout(OpenBlockFile(pos), SER_DISK, CLIENT_VERSION);
+      BOOST_REQUIRE(!fileout.IsNull());
+      fileout << block;
+    }
+
+    auto inserted =
+        mapBlockIndex.emplace(block.GetHash(), new CBlockIndex(block));
+    CBlockIndex *pindex = inserted.first->second;
+    pindex->phashBlock = &inserted.first->first;
+    pindex->pprev = pindexPrev;
+    pindex->nHeight = pindexPrev->nHeight + 1;
+    pindex->nFile = pos.nFile;
+    pindex->nDataPos = pos.nPos;
+    pindex->nStatus |= BLOCK_HAVE_DATA | BLOCK_PROOF_VALID;
+    pindex->BuildSkip();
+    pos.nPos += ::GetSerializeSize(block, SER_DISK, CLIENT_VERSION);
+
+    chainActive.SetTip(pindex);
+    AddBlockToBeePopIndex(block, pindex, params);
+    blocks[pindex] = block;
+    return pindex;
+  };
+
+  auto setHaveData = [&](bool fHaveData) {
+    for (const auto &entry : blocks)
+      if (fHaveData)
+        entry.first->nStatus |= BLOCK_HAVE_DATA;
+      else
+        entry.first->nStatus &= ~BLOCK_HAVE_DATA;
+  };
+
+  int immatureBees, immatureBCTs, matureBees, matureBCTs;
+  CAmount potentialLifespanRewards;
+  auto getNetworkHiveInfo = [&]() {
+    return GetNetworkHiveInfo(immatureBees, immatureBCTs, matureBees,
+                              matureBCTs, potentialLifespanRewards, params,
+                              true);
+  };
+
+  // The reference is the per-block walk GetNetworkHiveInfo made before the
+  // index, which read every block back and filled the graph bee by bee.
+  auto checkAgainstWalk = [&]() {
+    BOOST_REQUIRE(getNetworkHiveInfo());
+
+    int walkImmatureBees = 0, walkImmatureBCTs = 0;
+    int walkMatureBees = 0, walkMatureBCTs = 0;
+    std::vector<BeePopGraphPoint> graph(totalBeeLifespan, {0, 0});
+    CBlockIndex *pindex = chainActive.Tip();
+    const int tipHeight = pindex->nHeight;
+    for (int i = 0; i < totalBeeLifespan; i++, pindex = pindex->pprev) {
+      const CBlock &block = blocks.at(pindex);
+      if (block.IsHiveMined(params))
+        continue;
+      const CAmount beeCost = GetBeeCost(pindex->nHeight, params);
+      for (const CTransactionRef &tx : block.vtx) {
+        CAmount beeFeePaid;
+        if (!tx->IsBCT(params, scriptPubKeyBCF, &beeFeePaid))
+          continue;
+        if (tx->vout.size() > 1 && tx->vout[1].scriptPubKey == scriptPubKeyCF) {
+          const CAmount donation = tx->vout[1].nValue;
+          CAmount expectedDonation =
+              (beeFeePaid + donation) / params.communityContribFactor;
+          expectedDonation += expectedDonation >> 1;
+          if (donation != expectedDonation)
+            continue;
+          beeFeePaid += donation;
+        }
+        const int beeCount = beeFeePaid / beeCost;
+        if (i < params.beeGestationBlocks) {
+          walkImmatureBees += beeCount;
+          walkImmatureBCTs++;
+        } else {
+          walkMatureBees += beeCount;
+          walkMatureBCTs++;
+        }
+
+        const int beeMaturesBlock = pindex->nHeight + params.beeGestationBlocks;
+        const int beeDiesBlock = beeMaturesBlock + params.beeLifespanBlocks;
+        for (int j = pindex->nHeight; j < beeDiesBlock; j++) {
+          const int graphPos = j - tipHeight;
+          if (graphPos > 0 && graphPos < totalBeeLifespan) {
+            if (j < beeMaturesBlock)
+              graph[graphPos].immaturePop += beeCount;
+            else
+              graph[graphPos].maturePop += beeCount;
+          }
+        }
+      }
+    }
+
+    BOOST_CHECK_EQUAL(immatureBees, walkImmatureBees);
+    BOOST_CHECK_EQUAL(immatureBCTs, walkImmatureBCTs);
+    BOOST_CHECK_EQUAL(matureBees, walkMatureBees);
+    BOOST_CHECK_EQUAL(matureBCTs, walkMatureBCTs);
+    bool fGraphMatches = true;
+    for (int i = 0; i < totalBeeLifespan; i++)
+      fGraphMatches &= beePopGraph[i].immaturePop == graph[i].immaturePop &&
+                       beePopGraph[i].maturePop == graph[i].maturePop;
+    BOOST_CHECK(fGraphMatches);
+  };
+
+  // Connect: every block in the window comes from the index, so the walk
+  // succeeds even with no block data to read.
+  CBlockIndex *pindex = pindexOldTip;
+  for (int i = 0; i < 2 * totalBeeLifespan + 10; i++)
+    pindex = connectBlock(pindex, i % 5 == 4);
+  checkAgainstWalk();
+  setHaveData(false);
+  checkAgainstWalk();
+
+  // Pruning: connecting keeps exactly one lifespan of entries below the tip.
+  // A tip one block back still needs none older; two blocks back it needs a
+  // pruned one, which can't be read from disk here.
+  CBlockIndex *pindexTip = chainActive.Tip();
+  BOOST_REQUIRE(!chainActive[pindexTip->nHeight - totalBeeLifespan - 1]
+                     ->IsHiveMined(params));
+  chainActive.SetTip(pindexTip->pprev);
+  BOOST_CHECK(getNetworkHiveInfo());
+  chainActive.SetTip(pindexTip->pprev->pprev);
+  BOOST_CHECK(!getNetworkHiveInfo());
+  chainActive.SetTip(pindexTip);
+  setHaveData(true);
+
+  // Lazy fill: with the index emptied, as after a restart, the walk reads
+  // the blocks back and caches them for the next call.
+  for (const auto &entry : blocks)
+    RemoveBlockFromBeePopIndex(entry.first);
+  checkAgainstWalk();
+  setHaveData(false);
+  checkAgainstWalk();
+  setHaveData(true);
+
+  // Disconnect, then reorg onto a fork with different BCTs.
+  for (int i = 0; i < 20; i++) {
+    RemoveBlockFromBeePopIndex(chainActive.Tip());
+    chainActive.SetTip(chainActive.Tip()->pprev);
+  }
+  checkAgainstWalk();
+  pindex = chainActive.Tip();
+  for (int i = 0; i < 25; i++)
+    pindex = connectBlock(pindex, i % 5 == 4);
+  checkAgainstWalk();
+
+  // Entries left by the fork don't match the old branch, which is read back
+  // from disk instead.
+  chainActive.SetTip(pindexTip);
+  checkAgainstWalk();
+
+  for (const auto &entry : blocks)
+    RemoveBlockFromBeePopIndex(entry.first);
+  chainActive.SetTip(pindexOldTip);
+}
+
+BOOST_FIXTURE_TEST_CASE(read_block_skips_checked_proof, TestingSetup) {
+  const Consensus::Params &params = Params().GetConsensus();
+  CDiskBlockPos pos(1, 0);
+
+  LOCK(cs_main);
+  // Neither block carries a valid proof: the hive block claims no bee the
+  // chain knows of, and the PoW block's target can't be met.
+  for (bool fHive : {true, false}) {
+    CBlock block;
+    block.hashPrevBlock = chainActive.Tip()->GetBlockHash();
+    block.nTime = chainActive.Tip()->nTime + params.nPowTargetSpacing;
+    block.nBits = 0x03000001;
+    block.nNonce = fHive ? params.hiveNonceMarker : params.hiveNonceMarker + 1;
+    CMutableTransaction coinbase;
+    coinbase.vin.resize(1);
+    coinbase.vout.resize(1);
+    coinbase.vout[0].scriptPubKey = CScript() << OP_RETURN << OP_BEE;
+    block.vtx.push_back(MakeTransactionRef(std::move(coinbase)));
+    block.hashMerkleRoot = BlockMerkleRoot(block);
+    {
+      CAutoFile fileout(OpenBlockFile(pos), SER_DISK, CLIENT_VERSION);
+      BOOST_REQUIRE(!fileout.IsNull());
+      fileout << block;
+    }
+
+    const uint256 hash = block.GetHash();
+    CBlockIndex index(block);
+    index.phashBlock = &hash;
+    index.nFile = pos.nFile;
+    index.nDataPos = pos.nPos;
+    index.nStatus = BLOCK_HAVE_DATA;
+    pos.nPos += ::GetSerializeSize(block, SER_DISK, CLIENT_VERSION);
+    BOOST_REQUIRE_EQUAL(block.IsHiveMined(params), fHive);
+
+    // Until AcceptBlock has marked the entry, every read re-runs the proof
+    // check, which rejects the block.
+    CBlock blockRead;
+    BOOST_CHECK(!ReadBlockFromDisk(blockRead, &index, params));
+
+    // Once marked, the read returns the block without checking it again.
+    index.nStatus |= BLOCK_PROOF_VALID;
+    BOOST_CHECK(ReadBlockFromDisk(blockRead, &index, params));
+    BOOST_CHECK(blockRead.GetHash() == hash);
+
+    // Reads by position have no index entry to trust and always check.
+    BOOST_CHECK(!ReadBlockFromDisk(blockRead, index.GetBlockPos(), params));
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
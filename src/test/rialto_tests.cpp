@@ -0,0 +1,357 @@
+// Copyright (c) 2024 The Litecoin Cash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <base58.h>
+#include <chain.h>
+#include <chainparams.h>
+#include <crypto/aes.h>
+#include <key.h>
+#include <rialto.h>
+#include <streams.h>
+#include <test/test_bitcoin.h>
+#include <timedata.h>
+#include <utilstrencodings.h>
+#include <validation.h>
+#include <wallet/wallet.h>
+
+#include <algorithm>
+#include <set>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(rialto_tests, BasicTestingSetup)
+
+static RialtoLocalKey MakeLocalKey(const std::string &nick) {
+  CKey key;
+  key.MakeNewKey(true);
+  CPubKey pubKey = key.GetPubKey();
+
+  RialtoLocalKey localKey;
+  localKey.nick = nick;
+  localKey.pubKey.assign(pubKey.begin(), pubKey.end());
+  localKey.privKey.assign(key.begin(), key.end());
+  return localKey;
+}
+
+struct RialtoWalletSetup : public TestingSetup {
+  CWallet wallet;
+
+  RialtoWalletSetup() {
+    pwhitepages.reset(
+        new CRialtoWhitePagesDB("test_whitepages", (1 << 20), true, true));
+    pmynicks.reset(
+        new CRialtoWhitePagesDB("test_mynicks", (1 << 20), true, true));
+    pblockednicks.reset(
+        new CRialtoWhitePagesDB("test_blockednicks", (1 << 20), true, true));
+    vpwallets.push_back(&wallet);
+    RialtoInvalidateLocalKeyCache();
+  }
+
+  ~RialtoWalletSetup() {
+    vpwallets.erase(std::find(vpwallets.begin(), vpwallets.end(), &wallet));
+    RialtoInvalidateLocalKeyCache();
+    pblockednicks.reset();
+    pmynicks.reset();
+    pwhitepages.reset();
+    gArgs.ForceSetArg("-rialtorecipienttag", "0");
+  }
+
+  std::string NewPubKey(bool fMine) {
+    CKey key;
+    key.MakeNewKey(true);
+    CPubKey pubKey = key.GetPubKey();
+    if (fMine) {
+      LOCK(wallet.cs_wallet);
+      wallet.AddKeyPubKey(key, pubKey);
+    }
+    return HexStr(pubKey.begin(), pubKey.end());
+  }
+
+  std::string AddNick(const std::string &nick) {
+    const std::string pubKeyStr = NewPubKey(true);
+    pwhitepages->SetPubKeyForNick(nick, pubKeyStr);
+    return pubKeyStr;
+  }
+};
+
+static CTransactionRef MakeNCT(const std::string &nick,
+                               const std::string &pubKeyStr,
+                               const Consensus::Params &params) {
+  CMutableTransaction tx;
+  tx.vin.push_back(CTxIn(COutPoint(GetRandHash(), 0)));
+  tx.vout.push_back(CTxOut(
+      params.nickCreationCostStandard,
+      GetScriptForDestination(DecodeDestination(params.nickCreationAddress))));
+  tx.vout.push_back(
+      CTxOut(params.nickCreationAntiDust,
+             CScript() << OP_RETURN << ParseHex(pubKeyStr) << OP_NICK_CREATE
+                       << std::vector<unsigned char>(nick.begin(), nick.end())));
+  return MakeTransactionRef(tx);
+}
+
+BOOST_AUTO_TEST_CASE(rialto_recipient_tag) {
+  CKey key;
+  key.MakeNewKey(true);
+  CPubKey pubKey = key.GetPubKey();
+  std::vector<unsigned char> pubKeyVec(pubKey.begin(), pubKey.end());
+
+  const uint32_t epochStart = 1700000000 / RIALTO_RECIPIENT_TAG_EPOCH *
+                              RIALTO_RECIPIENT_TAG_EPOCH;
+  BOOST_CHECK_EQUAL(
+      RialtoRecipientTag(pubKeyVec, epochStart),
+      RialtoRecipientTag(pubKeyVec,
+                         epochStart + RIALTO_RECIPIENT_TAG_EPOCH - 1));
+
+  std::set<unsigned char> tags;
+  for (uint32_t i = 0; i < 16; i++)
+    tags.insert(RialtoRecipientTag(
+        pubKeyVec, epochStart + i * RIALTO_RECIPIENT_TAG_EPOCH));
+  BOOST_CHECK(tags.size() > 1);
+}
+
+BOOST_AUTO_TEST_CASE(rialto_nonce_search) {
+  const std::string dataToHash = "65f1c0de" + GetRandHash().GetHex();
+  for (int threads : {1, 3}) {
+    uint32_t nonce;
+    BOOST_CHECK(RialtoFindMessageNonce(dataToHash, threads, nonce));
+    arith_uint256 hash = UintToArith256(
+        CBlockHeader::MinotaurHashString(dataToHash + std::to_string(nonce)));
+    BOOST_CHECK(hash <= RIALTO_MESSAGE_POW_TARGET);
+  }
+}
+
+// Each message in a batch is timestamped when its own nonce search starts
+// and comes out as a layer 3 envelope that passes the checks applied to
+// inbound messages.
+BOOST_FIXTURE_TEST_CASE(encrypt_batch, RialtoWalletSetup) {
+  pmynicks->SetPubKeyForNick("alice", AddNick("alice"));
+  AddNick("bob");
+
+  std::vector<RialtoOutgoingMessage> messages(3);
+  messages[0].nickTo = "bob";
+  messages[1].nickTo = "nobody";
+  messages[2].nickTo = "bob";
+  for (RialtoOutgoingMessage &msg : messages) {
+    msg.nickFrom = "alice";
+    msg.plaintext = "hello " + msg.nickTo;
+  }
+  const uint32_t start = GetAdjustedTime();
+  RialtoEncryptMessages(messages);
+
+  BOOST_CHECK(!messages[1].fSuccess);
+  BOOST_CHECK_EQUAL(messages[1].err,
+                    "Can't find recipient pubkey in white pages.");
+  for (size_t i : {0, 2}) {
+    BOOST_REQUIRE(messages[i].fSuccess);
+    BOOST_CHECK(messages[i].timestampSent >= start);
+    std::string err;
+    uint32_t timestamp;
+    BOOST_CHECK(RialtoParseLayer3Envelope(messages[i].ciphertext, err,
+                                          nullptr, &timestamp));
+    BOOST_CHECK_EQUAL(timestamp, messages[i].timestampSent);
+  }
+}
+
+// Both envelope versions are sent and decrypted. Encrypted data is a whole
+// number of AES blocks around 16 + 33 + 32 bytes of IV, ephemeral pubkey and
+// MAC, so the receiver tells a tagged envelope apart by its length mod 16.
+BOOST_FIXTURE_TEST_CASE(layer2_envelope_round_trip, RialtoWalletSetup) {
+  const std::string alicePubKey = AddNick("alice");
+  const std::string bobPubKey = AddNick("bob");
+  pmynicks->SetPubKeyForNick("alice", alicePubKey);
+
+  for (bool fTagged : {false, true}) {
+    gArgs.ForceSetArg("-rialtorecipienttag", fTagged ? "1" : "0");
+    pmynicks->RemoveNick("bob");
+    RialtoInvalidateLocalKeyCache();
+
+    std::string dataToHash, err;
+    uint32_t now;
+    BOOST_CHECK(RialtoBuildLayer2Envelope("alice", "bob", "hello bob",
+                                          dataToHash, now, err));
+    const std::string layer2 = dataToHash.substr(8);
+    const size_t headerSize = fTagged ? RIALTO_L2_TAG_HEADER_LENGTH : 0;
+    BOOST_CHECK_EQUAL((layer2.size() / 2) % AES_BLOCKSIZE,
+                      (headerSize + 16 + 33 + 32) % AES_BLOCKSIZE);
+    if (fTagged) {
+      std::vector<unsigned char> header = ParseHex(layer2.substr(0, 4));
+      BOOST_CHECK_EQUAL(header[0], RIALTO_L2_VERSION_TAGGED);
+      BOOST_CHECK_EQUAL(header[1],
+                        RialtoRecipientTag(ParseHex(bobPubKey), now));
+    }
+
+    BOOST_CHECK(!RialtoDecryptLayer2Envelope(layer2, now, err));
+    BOOST_CHECK_EQUAL(err, "Not for us.");
+
+    pmynicks->SetPubKeyForNick("bob", bobPubKey);
+    RialtoInvalidateLocalKeyCache();
+    BOOST_CHECK(RialtoDecryptLayer2Envelope(layer2, now, err));
+    std::vector<RialtoQueuedMessage> messages = RialtoGetQueuedMessages();
+    BOOST_REQUIRE_EQUAL(messages.size(), 1U);
+    BOOST_CHECK(std::string(messages[0].fromNick.begin(),
+                            messages[0].fromNick.end()) == "alice");
+    BOOST_CHECK(std::string(messages[0].toNick.begin(),
+                            messages[0].toNick.end()) == "bob");
+    BOOST_CHECK(std::string(messages[0].message.begin(),
+                            messages[0].message.end()) == "hello bob");
+    BOOST_CHECK_EQUAL(messages[0].timestamp, now);
+
+    std::string tampered = layer2;
+    tampered[0] = 'z';
+    BOOST_CHECK(!RialtoDecryptLayer2Envelope(tampered, now, err));
+    BOOST_CHECK_EQUAL(err, "Layer 2 envelope is not hex.");
+
+    if (!fTagged)
+      continue;
+
+    std::vector<unsigned char> header = ParseHex(layer2.substr(0, 4));
+    header[1] ^= 1;
+    tampered = HexStr(header) + layer2.substr(4);
+    BOOST_CHECK(!RialtoDecryptLayer2Envelope(tampered, now, err));
+    BOOST_CHECK_EQUAL(err, "Not for us.");
+
+    tampered = layer2;
+    tampered.replace(0, 2, "02");
+    BOOST_CHECK(!RialtoDecryptLayer2Envelope(tampered, now, err));
+    BOOST_CHECK_EQUAL(err, "Unknown layer 2 envelope version.");
+  }
+}
+
+BOOST_AUTO_TEST_CASE(local_key_cache_invalidated_during_load) {
+  CRialtoLocalKeyCache cache;
+  std::vector<RialtoLocalKey> wallet = {MakeLocalKey("alice"),
+                                        MakeLocalKey("bob")};
+  int loads = 0;
+  bool fInvalidate = true;
+  auto loader = [&](std::vector<RialtoLocalKey> &keys) {
+    loads++;
+    keys = wallet;
+    if (fInvalidate)
+      cache.Invalidate();
+    return true;
+  };
+
+  BOOST_CHECK_EQUAL(cache.Get(loader).size(), 2U);
+  BOOST_CHECK_EQUAL(loads, 1);
+
+  fInvalidate = false;
+  BOOST_CHECK_EQUAL(cache.Get(loader).size(), 2U);
+  BOOST_CHECK_EQUAL(loads, 2);
+  BOOST_CHECK_EQUAL(cache.Get(loader).size(), 2U);
+  BOOST_CHECK_EQUAL(loads, 2);
+}
+
+BOOST_AUTO_TEST_CASE(local_key_cache_wallet_lock) {
+  CRialtoLocalKeyCache cache;
+  std::vector<RialtoLocalKey> wallet = {MakeLocalKey("alice"),
+                                        MakeLocalKey("bob")};
+  bool fLocked = false;
+  int loads = 0;
+  auto loader = [&](std::vector<RialtoLocalKey> &keys) {
+    loads++;
+    if (fLocked)
+      return false;
+    keys = wallet;
+    return true;
+  };
+
+  std::vector<RialtoLocalKey> keys = cache.Get(loader);
+  BOOST_CHECK_EQUAL(keys.size(), 2U);
+  BOOST_CHECK(keys[0].privKey == wallet[0].privKey);
+  BOOST_CHECK_EQUAL(cache.Get(loader).size(), 2U);
+  BOOST_CHECK_EQUAL(loads, 1);
+
+  fLocked = true;
+  cache.Invalidate();
+  BOOST_CHECK(cache.Get(loader).empty());
+  BOOST_CHECK(cache.Get(loader).empty());
+  BOOST_CHECK_EQUAL(loads, 3);
+
+  fLocked = false;
+  BOOST_CHECK_EQUAL(cache.Get(loader).size(), 2U);
+  BOOST_CHECK_EQUAL(cache.Get(loader).size(), 2U);
+  BOOST_CHECK_EQUAL(loads, 4);
+}
+
+// Blocks are written straight to a block file and linked onto the active
+// chain, so the white pages built block by block as they connect can be
+// compared with a rebuild that reads them back from disk.
+BOOST_FIXTURE_TEST_CASE(rebuild_white_pages, RialtoWalletSetup) {
+  Consensus::Params params = Params().GetConsensus();
+  params.vDeployments[Consensus::DEPLOYMENT_RIALTO].nStartTime =
+      Consensus::BIP9Deployment::ALWAYS_ACTIVE;
+
+  const std::vector<std::vector<CTransactionRef>> blockNCTs = {
+      {MakeNCT("alice", NewPubKey(true), params),
+       MakeNCT("bobby", NewPubKey(false), params)},
+      {},
+      {MakeNCT("carol", NewPubKey(false), params),
+       MakeNCT("alice", NewPubKey(false), params)},
+      {MakeNCT("carol", NewPubKey(true), params)},
+      {MakeNCT("david", NewPubKey(true), params),
+       MakeNCT("erin_", NewPubKey(false), params)}};
+
+  CBlockIndex *pindexOldTip;
+  {
+    LOCK(cs_main);
+    pindexOldTip = chainActive.Tip();
+    CBlockIndex *pindexPrev = pindexOldTip;
+    CDiskBlockPos pos(1, 0);
+    for (const std::vector<CTransactionRef> &vtx : blockNCTs) {
+      CBlock block;
+      block.hashPrevBlock = pindexPrev->GetBlockHash();
+      block.nTime = pindexPrev->nTime + 150;
+      block.vtx = vtx;
+      {
+        CAutoFile fileout(OpenBlockFile(pos), SER_DISK, CLIENT_VERSION);
+        BOOST_REQUIRE(!fileout.IsNull());
+        fileout << block;
+      }
+
+      auto inserted =
+          mapBlockIndex.emplace(block.GetHash(), new CBlockIndex(block));
+      CBlockIndex *pindex = inserted.first->second;
+      pindex->phashBlock = &inserted.first->first;
+      pindex->pprev = pindexPrev;
+      pindex->nHeight = pindexPrev->nHeight + 1;
+      pindex->nFile = pos.nFile;
+      pindex->nDataPos = pos.nPos;
+      pindex->nStatus |= BLOCK_HAVE_DATA | BLOCK_PROOF_VALID;
+      pindex->BuildSkip();
+      pos.nPos += ::GetSerializeSize(block, SER_DISK, CLIENT_VERSION);
+
+      chainActive.SetTip(pindex);
+      RialtoConnectBlockNicks(block, pindex, params);
+      pindexPrev = pindex;
+    }
+  }
+
+  const std::vector<std::pair<std::string, std::string>> whitePages =
+      pwhitepages->GetAll();
+  const std::vector<std::pair<std::string, std::string>> myNicks =
+      pmynicks->GetAll();
+  BOOST_CHECK_EQUAL(whitePages.size(), 5U);
+  BOOST_CHECK_EQUAL(myNicks.size(), 2U);
+
+  pwhitepages->ReplaceAll({{"mallory", NewPubKey(false)}});
+  pmynicks->ReplaceAll({});
+  std::string err;
+  BOOST_CHECK(RialtoRebuildWhitePages(1, params, err));
+  BOOST_CHECK(pwhitepages->GetAll() == whitePages);
+  BOOST_CHECK(pmynicks->GetAll() == myNicks);
+
+  {
+    LOCK(cs_main);
+    chainActive[3]->nStatus &= ~BLOCK_HAVE_DATA;
+  }
+  pwhitepages->ReplaceAll({});
+  BOOST_CHECK(!RialtoRebuildWhitePages(1, params, err));
+  BOOST_CHECK(err.find("pruned") != std::string::npos);
+  BOOST_CHECK(pwhitepages->GetAll().empty());
+
+  LOCK(cs_main);
+  chainActive.SetTip(pindexOldTip);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -7,6 +7,7 @@
 
 #include <base58.h>
 #include <core_io.h>
+#include <miner.h>
 #include <netbase.h>
 
 #include <test/test_bitcoin.h>
@@ -124,6 +125,20 @@ BOOST_AUTO_TEST_CASE(rpc_togglenetwork) {
   BOOST_CHECK_EQUAL(netState, true);
 }
 
+BOOST_AUTO_TEST_CASE(rpc_gethivestats) {
+  UniValue r;
+
+  BOOST_CHECK_NO_THROW(r = CallRPC("gethivestats"));
+  BOOST_CHECK_EQUAL(find_value(r.get_obj(), "rounds").get_int(), 0);
+  BOOST_CHECK_EQUAL(find_value(r.get_obj(), "window").get_int(),
+                    (int)HIVE_STATS_ROUNDS);
+  UniValue hashing = find_value(r.get_obj(), "hashing_ms");
+  BOOST_CHECK_EQUAL(find_value(hashing.get_obj(), "count").get_int(), 0);
+  BOOST_CHECK(find_value(r.get_obj(), "last").isNull());
+
+  BOOST_CHECK_THROW(CallRPC("gethivestats 1"), std::runtime_error);
+}
+
 BOOST_AUTO_TEST_CASE(rpc_rawsign) {
   UniValue r;
 
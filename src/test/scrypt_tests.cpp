@@ -52,4 +52,35 @@ BOOST_AUTO_TEST_CASE(scrypt_hashtest) {
   }
 }
 
+BOOST_AUTO_TEST_CASE(scrypt_multi_matches_generic) {
+  scrypt_detect_multiway();
+
+  const size_t count = 19;
+  std::vector<char> input(80 * count), output(32 * count);
+  for (size_t i = 0; i < input.size(); i++)
+    input[i] = (char)(i * 131 + 17);
+  scrypt_1024_1_1_256_multi(input.data(), output.data(), count);
+
+  char scratchpad[SCRYPT_SCRATCHPAD_SIZE];
+  char expected[32];
+  for (size_t i = 0; i < count; i++) {
+    scrypt_1024_1_1_256_sp_generic(&input[80 * i], expected, scratchpad);
+    BOOST_CHECK(memcmp(expected, &output[32 * i], 32) == 0);
+  }
+
+  std::vector<unsigned char> header = ParseHex(
+      "020000004c1271c211717198227392b029a64a7971931d351b387bb80db027f270411e39"
+      "8a07046f7d4a08dd815412a8712f874a7ebf0507e3878bd24e20a3b73fd750a667d2f451"
+      "eac7471b00de6659");
+  std::vector<char> headers;
+  for (int i = 0; i < 8; i++)
+    headers.insert(headers.end(), header.begin(), header.end());
+  std::vector<uint256> hashes(8);
+  scrypt_1024_1_1_256_multi(headers.data(), BEGIN(hashes[0]), 8);
+  for (const uint256 &hash : hashes)
+    BOOST_CHECK_EQUAL(
+        hash.ToString(),
+        "00000000002bef4107f882f6115e0b01f348d21195dacd3582aa2dabd7985806");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -7,6 +7,7 @@
 #include <chainparams.h>
 #include <consensus/consensus.h>
 #include <consensus/validation.h>
+#include <crypto/scrypt.h>
 #include <crypto/sha256.h>
 #include <miner.h>
 #include <net_processing.h>
@@ -37,6 +38,7 @@ extern void noui_connect();
 
 BasicTestingSetup::BasicTestingSetup(const std::string &chainName) {
   SHA256AutoDetect();
+  scrypt_detect_multiway();
   RandomInit();
   ECC_Start();
   SetupEnvironment();
@@ -81,8 +83,10 @@ TestingSetup::TestingSetup(const std::string &chainName)
     }
   }
   nScriptCheckThreads = 3;
-  for (int i = 0; i < nScriptCheckThreads - 1; i++)
+  for (int i = 0; i < nScriptCheckThreads - 1; i++) {
     threadGroup.create_thread(&ThreadScriptCheck);
+    threadGroup.create_thread(&ThreadPoWCheck);
+  }
   g_connman = std::unique_ptr<CConnman>(new CConnman(0x1337, 0x1337));
 
   connman = g_connman.get();
@@ -135,7 +139,7 @@ CBlock TestChain100Setup::CreateAndProcessBlock(
     IncrementExtraNonce(&block, chainActive.Tip(), extraNonce);
   }
 
-  while (!CheckProofOfWork(block.GetPoWHash(), block.nBits,
+  while (!CheckProofOfWork(block.ComputePoWHash(), block.nBits,
                            chainparams.GetConsensus()))
     ++block.nNonce;
 
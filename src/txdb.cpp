@@ -6,6 +6,7 @@
 #include <txdb.h>
 
 #include <chainparams.h>
+#include <crypto/common.h>
 #include <hash.h>
 #include <init.h>
 #include <pow.h>
@@ -22,6 +23,8 @@ static const char DB_COIN = 'C';
 static const char DB_COINS = 'c';
 static const char DB_BLOCK_FILES = 'f';
 static const char DB_TXINDEX = 't';
+static const char DB_BCTINDEX = 'h';
+static const char DB_BCTHEIGHT = 'j';
 static const char DB_BLOCK_INDEX = 'b';
 
 static const char DB_BEST_BLOCK = 'B';
@@ -50,6 +53,33 @@ struct CoinEntry {
   }
 };
 
+// Lists the BCTs a block mined. The height is stored big endian so entries
+// sort by height and pruning can erase a range of them in one pass.
+struct BCTHeightEntry {
+  char key;
+  int nHeight;
+  uint256 hashBlock;
+  explicit BCTHeightEntry(int nHeightIn = 0,
+                          const uint256 &hashBlockIn = uint256())
+      : key(DB_BCTHEIGHT), nHeight(nHeightIn), hashBlock(hashBlockIn) {}
+
+  template <typename Stream> void Serialize(Stream &s) const {
+    unsigned char height[4];
+    WriteBE32(height, nHeight);
+    s << key;
+    s.write((const char *)height, sizeof(height));
+    s << hashBlock;
+  }
+
+  template <typename Stream> void Unserialize(Stream &s) {
+    unsigned char height[4];
+    s >> key;
+    s.read((char *)height, sizeof(height));
+    nHeight = ReadBE32(height);
+    s >> hashBlock;
+  }
+};
+
 } // namespace
 
 CCoinsViewDB::CCoinsViewDB(size_t nCacheSize, bool fMemory, bool fWipe)
@@ -243,6 +273,50 @@ bool CBlockTreeDB::WriteTxIndex(
   return WriteBatch(batch);
 }
 
+bool CBlockTreeDB::ReadBCTIndex(const uint256 &txid, CDiskBCTInfo &info) {
+  return Read(std::make_pair(DB_BCTINDEX, txid), info);
+}
+
+bool CBlockTreeDB::WriteBCTIndex(
+    const std::vector<std::pair<uint256, CDiskBCTInfo>> &vect) {
+  CDBBatch batch(*this);
+  std::map<std::pair<int, uint256>, std::vector<uint256>> mapBlockBCTs;
+  for (const auto &entry : vect) {
+    batch.Write(std::make_pair(DB_BCTINDEX, entry.first), entry.second);
+    mapBlockBCTs[std::make_pair(entry.second.nHeight, entry.second.hashBlock)]
+        .push_back(entry.first);
+  }
+  for (const auto &block : mapBlockBCTs)
+    batch.Write(BCTHeightEntry(block.first.first, block.first.second),
+                block.second);
+  return WriteBatch(batch);
+}
+
+bool CBlockTreeDB::EraseBCTIndexToHeight(int nHeight) {
+  CDBBatch batch(*this);
+  std::unique_ptr<CDBIterator> pcursor(NewIterator());
+
+  pcursor->Seek(BCTHeightEntry());
+  for (; pcursor->Valid(); pcursor->Next()) {
+    BCTHeightEntry entry;
+    if (!pcursor->GetKey(entry) || entry.key != DB_BCTHEIGHT ||
+        entry.nHeight > nHeight)
+      break;
+    std::vector<uint256> vTxids;
+    if (!pcursor->GetValue(vTxids))
+      return error("%s: failed to read BCT height entry", __func__);
+
+    // A BCT mined again on another branch may have replaced the txid entry.
+    for (const uint256 &txid : vTxids) {
+      CDiskBCTInfo info;
+      if (ReadBCTIndex(txid, info) && info.nHeight <= nHeight)
+        batch.Erase(std::make_pair(DB_BCTINDEX, txid));
+    }
+    batch.Erase(entry);
+  }
+  return batch.SizeEstimate() == 0 || WriteBatch(batch);
+}
+
 bool CBlockTreeDB::WriteFlag(const std::string &name, bool fValue) {
   return Write(std::make_pair(DB_FLAG, name), fValue ? '1' : '0');
 }
@@ -51,6 +51,32 @@ struct CDiskTxPos : public CDiskBlockPos {
   }
 };
 
+struct CDiskBCTInfo {
+  int nHeight;
+  uint256 hashBlock;
+  CTxOut beeFeeOut;
+  CTxOut communityOut;
+
+  ADD_SERIALIZE_METHODS;
+
+  template <typename Stream, typename Operation>
+  inline void SerializationOp(Stream &s, Operation ser_action) {
+    READWRITE(VARINT(nHeight));
+    READWRITE(hashBlock);
+    READWRITE(beeFeeOut);
+    READWRITE(communityOut);
+  }
+
+  CDiskBCTInfo() { SetNull(); }
+
+  void SetNull() {
+    nHeight = 0;
+    hashBlock.SetNull();
+    beeFeeOut.SetNull();
+    communityOut.SetNull();
+  }
+};
+
 class CCoinsViewDB final : public CCoinsView {
 protected:
   CDBWrapper db;
@@ -107,6 +133,10 @@ public:
   bool ReadReindexing(bool &fReindexing);
   bool ReadTxIndex(const uint256 &txid, CDiskTxPos &pos);
   bool WriteTxIndex(const std::vector<std::pair<uint256, CDiskTxPos>> &vect);
+  bool ReadBCTIndex(const uint256 &txid, CDiskBCTInfo &info);
+  bool
+  WriteBCTIndex(const std::vector<std::pair<uint256, CDiskBCTInfo>> &vect);
+  bool EraseBCTIndexToHeight(int nHeight);
   bool WriteFlag(const std::string &name, bool fValue);
   bool ReadFlag(const std::string &name, bool &fValue);
   bool LoadBlockIndexGuts(
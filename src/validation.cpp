@@ -14,6 +14,7 @@
 #include <consensus/merkle.h>
 #include <consensus/tx_verify.h>
 #include <consensus/validation.h>
+#include <crypto/minotaurx/minotaur.h>
 #include <cuckoocache.h>
 #include <hash.h>
 #include <init.h>
@@ -49,6 +50,7 @@
 
 #include <base58.h>
 
+#include <atomic>
 #include <future>
 #include <sstream>
 
@@ -123,8 +125,8 @@ public:
                          std::shared_ptr<const CBlock> pblock);
 
   bool AcceptBlockHeader(const CBlockHeader &block, CValidationState &state,
-                         const CChainParams &chainparams,
-                         CBlockIndex **ppindex);
+                         const CChainParams &chainparams, CBlockIndex **ppindex,
+                         bool fCheckPOW = true);
   bool AcceptBlock(const std::shared_ptr<const CBlock> &pblock,
                    CValidationState &state, const CChainParams &chainparams,
                    CBlockIndex **ppindex, bool fRequested,
@@ -912,8 +914,8 @@ WriteBlockToDisk(const CBlock &block, CDiskBlockPos &pos,
   return true;
 }
 
-bool ReadBlockFromDisk(CBlock &block, const CDiskBlockPos &pos,
-                       const Consensus::Params &consensusParams) {
+static bool ReadBlockFromDiskUnchecked(CBlock &block,
+                                       const CDiskBlockPos &pos) {
   block.SetNull();
 
   CAutoFile filein(OpenBlockFile(pos, true), SER_DISK, CLIENT_VERSION);
@@ -928,6 +930,12 @@ bool ReadBlockFromDisk(CBlock &block, const CDiskBlockPos &pos,
                  pos.ToString());
   }
 
+  return true;
+}
+
+static bool CheckBlockProofFromDisk(const CBlock &block,
+                                    const CDiskBlockPos &pos,
+                                    const Consensus::Params &consensusParams) {
   if (block.IsHiveMined(consensusParams)) {
     if (!CheckHiveProof(&block, consensusParams))
       return error("ReadBlockFromDisk: Errors in Hive block header at %s",
@@ -941,21 +949,37 @@ bool ReadBlockFromDisk(CBlock &block, const CDiskBlockPos &pos,
   return true;
 }
 
+bool ReadBlockFromDisk(CBlock &block, const CDiskBlockPos &pos,
+                       const Consensus::Params &consensusParams) {
+  if (!ReadBlockFromDiskUnchecked(block, pos))
+    return false;
+
+  return CheckBlockProofFromDisk(block, pos, consensusParams);
+}
+
 bool ReadBlockFromDisk(CBlock &block, const CBlockIndex *pindex,
                        const Consensus::Params &consensusParams) {
   CDiskBlockPos blockPos;
+  bool fProofValid;
   {
     LOCK(cs_main);
     blockPos = pindex->GetBlockPos();
+    fProofValid = pindex->nStatus & BLOCK_PROOF_VALID;
   }
 
-  if (!ReadBlockFromDisk(block, blockPos, consensusParams))
+  if (!ReadBlockFromDiskUnchecked(block, blockPos))
     return false;
   if (block.GetHash() != pindex->GetBlockHash())
     return error("ReadBlockFromDisk(CBlock&, CBlockIndex*): GetHash() doesn't "
                  "match index for %s at %s",
                  pindex->ToString(), pindex->GetBlockPos().ToString());
-  return true;
+
+  // The header hash matches an index entry whose PoW or Hive proof has
+  // already been verified, so the block can be returned as plain I/O.
+  if (fProofValid)
+    return true;
+
+  return CheckBlockProofFromDisk(block, blockPos, consensusParams);
 }
 
 CAmount GetBlockSubsidy(int nHeight, const Consensus::Params &consensusParams) {
@@ -1384,6 +1408,8 @@ DisconnectResult CChainState::DisconnectBlock(const CBlock &block,
 
   view.SetBestBlock(pindex->pprev->GetBlockHash());
 
+  RemoveBlockFromBeePopIndex(pindex);
+
   return fClean ? DISCONNECT_OK : DISCONNECT_UNCLEAN;
 }
 
@@ -1454,6 +1480,45 @@ static bool WriteTxIndexDataForBlock(const CBlock &block,
   return true;
 }
 
+static const int BCT_INDEX_PRUNE_INTERVAL = 1000;
+
+static bool WriteBCTIndexDataForBlock(const CBlock &block,
+                                      CValidationState &state,
+                                      const CBlockIndex *pindex,
+                                      const Consensus::Params &consensusParams) {
+  // BCTs past gestation plus lifespan can no longer back a hive proof. Keep
+  // MIN_BLOCKS_TO_KEEP more so proofs in a reorg still find theirs, and
+  // prune in batches so most blocks don't touch the index at all.
+  int nPruneHeight = pindex->nHeight - consensusParams.beeGestationBlocks -
+                     consensusParams.beeLifespanBlocks - MIN_BLOCKS_TO_KEEP;
+  if (nPruneHeight > 0 && nPruneHeight % BCT_INDEX_PRUNE_INTERVAL == 0 &&
+      !pblocktree->EraseBCTIndexToHeight(nPruneHeight))
+    return AbortNode(state, "Failed to prune BCT index");
+
+  if (block.IsHiveMined(consensusParams))
+    return true;
+
+  CScript scriptPubKeyBCF = GetScriptForDestination(
+      DecodeDestination(consensusParams.beeCreationAddress));
+  std::vector<std::pair<uint256, CDiskBCTInfo>> vInfo;
+  for (const CTransactionRef &tx : block.vtx) {
+    if (tx->IsCoinBase() || !tx->IsBCT(consensusParams, scriptPubKeyBCF))
+      continue;
+    CDiskBCTInfo info;
+    info.nHeight = pindex->nHeight;
+    info.hashBlock = pindex->GetBlockHash();
+    info.beeFeeOut = tx->vout[0];
+    if (tx->vout.size() > 1)
+      info.communityOut = tx->vout[1];
+    vInfo.push_back(std::make_pair(tx->GetHash(), info));
+  }
+
+  if (!vInfo.empty() && !pblocktree->WriteBCTIndex(vInfo))
+    return AbortNode(state, "Failed to write BCT index");
+
+  return true;
+}
+
 static CCheckQueue<CScriptCheck> scriptcheckqueue(128);
 
 void ThreadScriptCheck() {
@@ -1461,6 +1526,93 @@ void ThreadScriptCheck() {
   scriptcheckqueue.Thread();
 }
 
+// Each worker is long-lived, so its MinotaurHasher, including the yespower
+// scratch memory, is allocated once per thread and reused for every check.
+static CCheckQueue<CPoWCheck> powcheckqueue(16);
+
+void ThreadPoWCheck() {
+  RenameThread("litecoincash-powchk");
+  powcheckqueue.Thread();
+}
+
+bool CPoWCheck::operator()() {
+  if (count > 1) {
+    std::vector<uint256> hashes(count);
+    CBlockHeader::GetScryptPoWHashes(header, count, hashes.data());
+    for (size_t i = 0; i < count; i++)
+      result[i] = UintToArith256(hashes[i]) <= target[i];
+    return true;
+  }
+
+  arith_uint256 hash;
+  if (header)
+    hash = UintToArith256(header->GetPoWHash());
+  else
+    hash = UintToArith256(MinotaurHasher::ForThisThread().Hash(
+        input->data, input->len, input->minotaurX));
+  *result = hash <= *target;
+  return true;
+}
+
+static const size_t SCRYPT_POW_CHECK_BATCH = 8;
+
+static const size_t VERIFYDB_POW_WINDOW = 512;
+
+static const size_t HEADERS_POW_CHUNK = 64;
+
+static std::vector<bool> RunPoWChecks(std::vector<CPoWCheck> &vChecks,
+                                      const std::vector<char> &results) {
+  if (nScriptCheckThreads) {
+    CCheckQueueControl<CPoWCheck> control(&powcheckqueue);
+    control.Add(vChecks);
+    control.Wait();
+  } else {
+    for (CPoWCheck &check : vChecks)
+      check();
+  }
+  return std::vector<bool>(results.begin(), results.end());
+}
+
+std::vector<bool>
+MinotaurBatchVerify(const std::vector<CMinotaurVerifyInput> &inputs,
+                    const std::vector<arith_uint256> &targets) {
+  assert(inputs.size() == targets.size());
+  std::vector<char> results(inputs.size(), false);
+  std::vector<CPoWCheck> vChecks;
+  vChecks.reserve(inputs.size());
+  for (size_t i = 0; i < inputs.size(); i++)
+    vChecks.emplace_back(inputs[i], targets[i], results[i]);
+  return RunPoWChecks(vChecks, results);
+}
+
+std::vector<bool> HeadersBatchVerify(const std::vector<CBlockHeader> &headers,
+                                     const Consensus::Params &params) {
+  std::vector<char> results(headers.size(), false);
+  std::vector<arith_uint256> targets(headers.size());
+  std::vector<char> fValidTarget(headers.size(), false);
+  for (size_t i = 0; i < headers.size(); i++)
+    fValidTarget[i] = DecodePoWTarget(
+        headers[i].nBits, GetPoWLimit(headers[i], params), targets[i]);
+
+  std::vector<CPoWCheck> vChecks;
+  vChecks.reserve(headers.size());
+  for (size_t i = 0; i < headers.size();) {
+    if (!fValidTarget[i]) {
+      i++;
+      continue;
+    }
+    size_t count = 1;
+    if (headers[i].IsScryptPoW()) {
+      while (count < SCRYPT_POW_CHECK_BATCH && i + count < headers.size() &&
+             fValidTarget[i + count] && headers[i + count].IsScryptPoW())
+        count++;
+    }
+    vChecks.emplace_back(headers[i], targets[i], results[i], count);
+    i += count;
+  }
+  return RunPoWChecks(vChecks, results);
+}
+
 VersionBitsCache versionbitscache;
 
 int32_t ComputeBlockVersion(const CBlockIndex *pindexPrev,
@@ -1790,6 +1942,12 @@ bool CChainState::ConnectBlock(const CBlock &block, CValidationState &state,
   if (!WriteTxIndexDataForBlock(block, state, pindex))
     return false;
 
+  if (!WriteBCTIndexDataForBlock(block, state, pindex,
+                                 chainparams.GetConsensus()))
+    return false;
+
+  AddBlockToBeePopIndex(block, pindex, chainparams.GetConsensus());
+
   assert(pindex->phashBlock);
 
   view.SetBestBlock(pindex->GetBlockHash());
@@ -2051,6 +2209,7 @@ bool CChainState::DisconnectTip(CValidationState &state,
 
         if (pmynicks->NickExists(nick)) {
           pmynicks->RemoveNick(nick);
+          RialtoInvalidateLocalKeyCache();
           LogPrint(BCLog::RIALTO,
                    "Rialto: Removed nick %s from local white pages "
                    "(disconnected tip)\n",
@@ -2213,61 +2372,8 @@ bool CChainState::ConnectTip(CValidationState &state,
   mempool.removeForBlock(blockConnecting.vtx, pindexNew->nHeight);
   disconnectpool.removeForBlock(blockConnecting.vtx);
 
-  if (IsRialtoEnabled(pindexNew, chainparams.GetConsensus())) {
-    CScript scriptPubKeyNCF = GetScriptForDestination(
-        DecodeDestination(chainparams.GetConsensus().nickCreationAddress));
-
-    for (unsigned long int i = 0; i < blockConnecting.vtx.size(); i++) {
-      const CTransaction &tx = *(blockConnecting.vtx[i]);
-      std::string nickname;
-      std::string pubKeyStr;
-      if (tx.IsNCT(chainparams.GetConsensus(), scriptPubKeyNCF, &pubKeyStr,
-                   &nickname)) {
-        if (pwhitepages->NickExists(nickname)) {
-          LogPrint(BCLog::RIALTO,
-                   "Rialto: Ignoring duplicate registration for nick %s\n",
-                   nickname);
-        } else {
-          CPubKey pubKey(ParseHex(pubKeyStr));
-          CTxDestination rialtoDestination =
-              GetDestinationForKey(pubKey, OUTPUT_TYPE_LEGACY);
-
-          pwhitepages->SetPubKeyForNick(nickname, pubKeyStr);
-          LogPrint(BCLog::RIALTO,
-                   "Rialto: Added nick %s to global whitepages\n", nickname);
-
-          const CKeyID *keyID = boost::get<CKeyID>(&rialtoDestination);
-          if (keyID) {
-            CKey key;
-
-            JSONRPCRequest request;
-            CWallet *const pwallet = GetWalletForJSONRPCRequest(request);
-            if (!EnsureWalletIsAvailable(pwallet, true)) {
-              LogPrintf("Rialto: ERROR: Can't check if nick %s is local; "
-                        "wallet unavailable\n",
-                        nickname);
-              continue;
-            }
-
-            if (pwallet->IsLocked()) {
-              LogPrintf("Rialto: ERROR: Can't check if nick %s is local; "
-                        "wallet locked\n",
-                        nickname);
-              continue;
-            }
-
-            if (pwallet->GetKey(*keyID, key)) {
-              pmynicks->SetPubKeyForNick(nickname, pubKeyStr);
-              LogPrint(BCLog::RIALTO,
-                       "Rialto: Added our nick %s to local whitepages\n",
-                       nickname);
-            } else {
-            }
-          }
-        }
-      }
-    }
-  }
+  RialtoConnectBlockNicks(blockConnecting, pindexNew,
+                          chainparams.GetConsensus());
 
   chainActive.SetTip(pindexNew);
   UpdateTip(pindexNew, chainparams);
@@ -2719,6 +2825,7 @@ CBlockIndex *CChainState::AddToBlockIndex(const CBlockHeader &block) {
     pindexNew->pprev = (*miPrev).second;
     pindexNew->nHeight = pindexNew->pprev->nHeight + 1;
     pindexNew->BuildSkip();
+    pindexNew->BuildPrevSameKind(Params().GetConsensus());
   }
   pindexNew->nTimeMax =
       (pindexNew->pprev ? std::max(pindexNew->pprev->nTimeMax, pindexNew->nTime)
@@ -3021,6 +3128,185 @@ std::vector<std::pair<std::string, std::string>> RialtoGetAllLocal() {
   return pmynicks->GetAll();
 }
 
+void RialtoConnectBlockNicks(const CBlock &block, const CBlockIndex *pindex,
+                             const Consensus::Params &consensusParams) {
+  if (!IsRialtoEnabled(pindex, consensusParams))
+    return;
+
+  CScript scriptPubKeyNCF = GetScriptForDestination(
+      DecodeDestination(consensusParams.nickCreationAddress));
+
+  for (unsigned long int i = 0; i < block.vtx.size(); i++) {
+    const CTransaction &tx = *(block.vtx[i]);
+    std::string nickname;
+    std::string pubKeyStr;
+    if (tx.IsNCT(consensusParams, scriptPubKeyNCF, &pubKeyStr, &nickname)) {
+      if (pwhitepages->NickExists(nickname)) {
+        LogPrint(BCLog::RIALTO,
+                 "Rialto: Ignoring duplicate registration for nick %s\n",
+                 nickname);
+      } else {
+        CPubKey pubKey(ParseHex(pubKeyStr));
+        CTxDestination rialtoDestination =
+            GetDestinationForKey(pubKey, OUTPUT_TYPE_LEGACY);
+
+        pwhitepages->SetPubKeyForNick(nickname, pubKeyStr);
+        LogPrint(BCLog::RIALTO,
+                 "Rialto: Added nick %s to global whitepages\n", nickname);
+
+        const CKeyID *keyID = boost::get<CKeyID>(&rialtoDestination);
+        if (keyID) {
+          CKey key;
+
+          JSONRPCRequest request;
+          CWallet *const pwallet = GetWalletForJSONRPCRequest(request);
+          if (!EnsureWalletIsAvailable(pwallet, true)) {
+            LogPrintf("Rialto: ERROR: Can't check if nick %s is local; "
+                      "wallet unavailable\n",
+                      nickname);
+            continue;
+          }
+
+          if (pwallet->IsLocked()) {
+            LogPrintf("Rialto: ERROR: Can't check if nick %s is local; "
+                      "wallet locked\n",
+                      nickname);
+            continue;
+          }
+
+          if (pwallet->GetKey(*keyID, key)) {
+            pmynicks->SetPubKeyForNick(nickname, pubKeyStr);
+            RialtoInvalidateLocalKeyCache();
+            LogPrint(BCLog::RIALTO,
+                     "Rialto: Added our nick %s to local whitepages\n",
+                     nickname);
+          } else {
+          }
+        }
+      }
+    }
+  }
+}
+
+bool RialtoRebuildWhitePages(int nStartHeight,
+                             const Consensus::Params &consensusParams,
+                             std::string &err) {
+  JSONRPCRequest request;
+  CWallet *const pwallet = GetWalletForJSONRPCRequest(request);
+  if (!EnsureWalletIsAvailable(pwallet, true)) {
+    err = "Wallet unavailable";
+    return false;
+  }
+
+  // The block list is only walked and checked for block data under cs_main;
+  // the workers below read each block by index entry, which looks up its
+  // file position under the lock as well.
+  std::vector<const CBlockIndex *> blocks;
+  auto collectBlocks = [&](const CBlockIndex *pindex) {
+    AssertLockHeld(cs_main);
+    for (; pindex; pindex = chainActive.Next(pindex)) {
+      if (!IsRialtoEnabled(pindex, consensusParams))
+        continue;
+      if (!(pindex->nStatus & BLOCK_HAVE_DATA)) {
+        err = strprintf("Block %d has been pruned; rebuilding the white "
+                        "pages needs every block since Rialto activation",
+                        pindex->nHeight);
+        return false;
+      }
+      blocks.push_back(pindex);
+    }
+    return true;
+  };
+
+  {
+    LOCK(cs_main);
+    if (!collectBlocks(chainActive[nStartHeight]))
+      return false;
+  }
+
+  const int64_t nStart = GetTimeMillis();
+  const CScript scriptPubKeyNCF = GetScriptForDestination(
+      DecodeDestination(consensusParams.nickCreationAddress));
+
+  std::vector<std::vector<std::pair<std::string, std::string>>> registrations(
+      blocks.size());
+  auto scanBlock = [&](size_t i) {
+    CBlock block;
+    if (!ReadBlockFromDisk(block, blocks[i], consensusParams))
+      return false;
+    for (const CTransactionRef &tx : block.vtx) {
+      std::string nickname;
+      std::string pubKeyStr;
+      if (tx->IsNCT(consensusParams, scriptPubKeyNCF, &pubKeyStr, &nickname))
+        registrations[i].emplace_back(nickname, pubKeyStr);
+    }
+    return true;
+  };
+
+  std::atomic<size_t> cursor(0);
+  std::atomic<bool> fFailed(false);
+  auto worker = [&]() {
+    for (size_t i = cursor++; i < blocks.size() && !fFailed; i = cursor++)
+      if (!scanBlock(i))
+        fFailed = true;
+  };
+
+  std::vector<std::thread> threads;
+  for (int i = 1; i < GetNumVirtualCores(); i++)
+    threads.emplace_back(worker);
+  worker();
+  for (std::thread &thread : threads)
+    thread.join();
+
+  if (fFailed) {
+    err = "Failed to read block from disk";
+    return false;
+  }
+
+  LOCK(cs_main);
+
+  if (!blocks.empty() && !chainActive.Contains(blocks.back())) {
+    err = "Active chain changed during rebuild; try again";
+    return false;
+  }
+  const size_t nScanned = blocks.size();
+  if (!collectBlocks(blocks.empty() ? chainActive[nStartHeight]
+                                    : chainActive.Next(blocks.back())))
+    return false;
+  registrations.resize(blocks.size());
+  for (size_t i = nScanned; i < blocks.size(); i++) {
+    if (!scanBlock(i)) {
+      err = "Failed to read block from disk";
+      return false;
+    }
+  }
+
+  std::map<std::string, std::string> whitePages;
+  std::map<std::string, std::string> myNicks;
+  for (const auto &blockRegistrations : registrations) {
+    for (const auto &registration : blockRegistrations) {
+      if (!whitePages.emplace(registration).second)
+        continue;
+
+      CPubKey pubKey(ParseHex(registration.second));
+      if (pwallet->HaveKey(pubKey.GetID()))
+        myNicks.insert(registration);
+    }
+  }
+
+  if (!pwhitepages->ReplaceAll(whitePages) || !pmynicks->ReplaceAll(myNicks)) {
+    err = "Failed to write white pages";
+    return false;
+  }
+  RialtoInvalidateLocalKeyCache();
+
+  LogPrintf("Rialto: Rebuilt white pages from %u blocks: %u nicks, %u local "
+            "(%dms)\n",
+            blocks.size(), whitePages.size(), myNicks.size(),
+            GetTimeMillis() - nStart);
+  return true;
+}
+
 bool RialtoNickIsBlocked(const std::string nick) {
   LOCK(cs_main);
   return pblockednicks->NickExists(nick);
@@ -3141,6 +3427,18 @@ bool GetTxByHashAndHeight(const uint256 txHash, const int nHeight,
   return false;
 }
 
+bool GetIndexedBCT(const uint256 &txHash, const CBlockIndex *pindex,
+                   CDiskBCTInfo &info) {
+  if (!pblocktree->ReadBCTIndex(txHash, info))
+    return false;
+
+  if (info.nHeight > pindex->nHeight)
+    return false;
+
+  const CBlockIndex *pindexBCT = pindex->GetAncestor(info.nHeight);
+  return pindexBCT && pindexBCT->GetBlockHash() == info.hashBlock;
+}
+
 static int GetWitnessCommitmentIndex(const CBlock &block) {
   int commitpos = -1;
   if (!block.vtx.empty()) {
@@ -3376,7 +3674,7 @@ static bool ContextualCheckBlock(const CBlock &block, CValidationState &state,
 bool CChainState::AcceptBlockHeader(const CBlockHeader &block,
                                     CValidationState &state,
                                     const CChainParams &chainparams,
-                                    CBlockIndex **ppindex) {
+                                    CBlockIndex **ppindex, bool fCheckPOW) {
   AssertLockHeld(cs_main);
 
   uint256 hash = block.GetHash();
@@ -3394,7 +3692,7 @@ bool CChainState::AcceptBlockHeader(const CBlockHeader &block,
       return true;
     }
 
-    if (!CheckBlockHeader(block, state, chainparams.GetConsensus()))
+    if (!CheckBlockHeader(block, state, chainparams.GetConsensus(), fCheckPOW))
       return error("%s: Consensus::CheckBlockHeader: %s, %s", __func__,
                    hash.ToString(), FormatStateMessage(state));
 
@@ -3446,13 +3744,45 @@ bool ProcessNewBlockHeaders(const std::vector<CBlockHeader> &headers,
                             CBlockHeader *first_invalid) {
   if (first_invalid != nullptr)
     first_invalid->SetNull();
-  {
+
+  // The first header is checked alone and the rest in fixed chunks, each
+  // accepted before the next is hashed. A peer sending junk headers can
+  // then cost at most one chunk of PoW hashes per message.
+  size_t nChunk = 1;
+  for (size_t nStart = 0; nStart < headers.size();
+       nStart += nChunk, nChunk = HEADERS_POW_CHUNK) {
+    const size_t nEnd = std::min(nStart + nChunk, headers.size());
+    std::vector<bool> fPoWChecked(nEnd - nStart, false);
+    if (nScriptCheckThreads && nEnd - nStart > 1) {
+      std::vector<CBlockHeader> batch;
+      std::vector<size_t> batchPos;
+      {
+        LOCK(cs_main);
+        for (size_t i = nStart; i < nEnd; i++) {
+          if (headers[i].IsHiveMined(chainparams.GetConsensus()) ||
+              mapBlockIndex.count(headers[i].GetHash()))
+            continue;
+          batch.push_back(headers[i]);
+          batchPos.push_back(i - nStart);
+        }
+      }
+
+      // Verify the PoW of the chunk in parallel without holding cs_main.
+      // Headers that fail are checked again by the sequential path, so the
+      // first invalid header is identified and reported as before.
+      std::vector<bool> valid =
+          HeadersBatchVerify(batch, chainparams.GetConsensus());
+      for (size_t i = 0; i < batch.size(); i++)
+        fPoWChecked[batchPos[i]] = valid[i];
+    }
+
     LOCK(cs_main);
-    for (const CBlockHeader &header : headers) {
+    for (size_t i = nStart; i < nEnd; i++) {
+      const CBlockHeader &header = headers[i];
       CBlockIndex *pindex = nullptr;
 
-      if (!g_chainstate.AcceptBlockHeader(header, state, chainparams,
-                                          &pindex)) {
+      if (!g_chainstate.AcceptBlockHeader(header, state, chainparams, &pindex,
+                                          !fPoWChecked[i - nStart])) {
         if (first_invalid)
           *first_invalid = header;
 
@@ -3544,6 +3874,9 @@ bool CChainState::AcceptBlock(const std::shared_ptr<const CBlock> &pblock,
     return error("%s: %s", __func__, FormatStateMessage(state));
   }
 
+  pindex->nStatus |= BLOCK_PROOF_VALID;
+  setDirtyBlockIndex.insert(pindex);
+
   if (!IsInitialBlockDownload() && chainActive.Tip() == pindex->pprev)
     GetMainSignals().NewPoWValidBlock(pindex, pblock);
 
@@ -3873,8 +4206,10 @@ bool CChainState::LoadBlockIndex(const Consensus::Params &consensus_params,
         (!pindexBestInvalid ||
          pindex->nChainWork > pindexBestInvalid->nChainWork))
       pindexBestInvalid = pindex;
-    if (pindex->pprev)
+    if (pindex->pprev) {
       pindex->BuildSkip();
+      pindex->BuildPrevSameKind(consensus_params);
+    }
     if (pindex->IsValid(BLOCK_VALID_TREE) &&
         (pindexBestHeader == nullptr ||
          CBlockIndexWorkComparator()(pindexBestHeader, pindex)))
@@ -3972,6 +4307,32 @@ CVerifyDB::CVerifyDB() {
 
 CVerifyDB::~CVerifyDB() { uiInterface.ShowProgress("", 100, false); }
 
+// Checks the PoW of up to VERIFYDB_POW_WINDOW non-hive headers from pindex
+// back on the PoW check queue, stopping at nMinHeight and, when pruning, at
+// the first block without data. The hashes of headers that pass are added
+// to setPoWChecked. Returns the first block not covered.
+static const CBlockIndex *
+VerifyDBPoWWindow(const CBlockIndex *pindex, int nMinHeight,
+                  const Consensus::Params &params,
+                  std::set<uint256> &setPoWChecked) {
+  std::vector<CBlockHeader> headers;
+  for (; pindex && pindex->pprev && pindex->nHeight >= nMinHeight &&
+         headers.size() < VERIFYDB_POW_WINDOW;
+       pindex = pindex->pprev) {
+    if (fPruneMode && !(pindex->nStatus & BLOCK_HAVE_DATA))
+      break;
+    CBlockHeader header = pindex->GetBlockHeader();
+    if (!header.IsHiveMined(params))
+      headers.push_back(header);
+  }
+
+  std::vector<bool> valid = HeadersBatchVerify(headers, params);
+  for (size_t i = 0; i < headers.size(); i++)
+    if (valid[i])
+      setPoWChecked.insert(headers[i].GetHash());
+  return pindex;
+}
+
 bool CVerifyDB::VerifyDB(const CChainParams &chainparams, CCoinsView *coinsview,
                          int nCheckLevel, int nCheckDepth) {
   LOCK(cs_main);
@@ -3988,6 +4349,10 @@ bool CVerifyDB::VerifyDB(const CChainParams &chainparams, CCoinsView *coinsview,
   int nGoodTransactions = 0;
   CValidationState state;
   int reportDone = 0;
+
+  std::set<uint256> setPoWChecked;
+  const CBlockIndex *pindexPoWWindowEnd = chainActive.Tip();
+
   LogPrintf("[0%%]...");
   for (CBlockIndex *pindex = chainActive.Tip(); pindex && pindex->pprev;
        pindex = pindex->pprev) {
@@ -4009,6 +4374,12 @@ bool CVerifyDB::VerifyDB(const CChainParams &chainparams, CCoinsView *coinsview,
                 pindex->nHeight);
       break;
     }
+    if (nCheckLevel >= 1 && pindex == pindexPoWWindowEnd) {
+      setPoWChecked.clear();
+      pindexPoWWindowEnd = VerifyDBPoWWindow(
+          pindex, chainActive.Height() - nCheckDepth,
+          chainparams.GetConsensus(), setPoWChecked);
+    }
     CBlock block;
 
     if (!ReadBlockFromDisk(block, pindex, chainparams.GetConsensus()))
@@ -4016,7 +4387,8 @@ bool CVerifyDB::VerifyDB(const CChainParams &chainparams, CCoinsView *coinsview,
                    pindex->nHeight, pindex->GetBlockHash().ToString());
 
     if (nCheckLevel >= 1 &&
-        !CheckBlock(block, state, chainparams.GetConsensus()))
+        !CheckBlock(block, state, chainparams.GetConsensus(),
+                    !setPoWChecked.count(pindex->GetBlockHash())))
       return error("%s: *** found bad block at %d, hash=%s (%s)\n", __func__,
                    pindex->nHeight, pindex->GetBlockHash().ToString(),
                    FormatStateMessage(state));
@@ -4306,6 +4678,7 @@ void UnloadBlockIndex() {
   }
   mapBlockIndex.clear();
   fHavePruned = false;
+  ResetDifficultyCache();
 
   g_chainstate.UnloadBlockIndex();
 }
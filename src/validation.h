@@ -11,6 +11,7 @@
 #endif
 
 #include <amount.h>
+#include <arith_uint256.h>
 #include <coins.h>
 #include <fs.h>
 #include <policy/feerate.h>
@@ -42,6 +43,7 @@ class CScriptCheck;
 class CBlockPolicyEstimator;
 class CTxMemPool;
 class CValidationState;
+struct CDiskBCTInfo;
 struct ChainTxData;
 
 struct PrecomputedTransactionData;
@@ -209,6 +211,7 @@ void FlushStateToDisk();
 void PruneAndFlush();
 void PruneBlockFilesManual(int nManualPruneHeight);
 void PruneOneBlockFile(const int fileNumber);
+void ThreadPoWCheck();
 void ThreadScriptCheck();
 void UnlinkPrunedFiles(const std::set<int> &setFilesToPrune);
 void UnloadBlockIndex();
@@ -250,6 +253,55 @@ public:
   ScriptError GetScriptError() const { return error; }
 };
 
+// One independent Minotaur hash to verify: the hash of len bytes at data,
+// with the MinotaurX hardened hash when minotaurX is set.
+struct CMinotaurVerifyInput {
+  const unsigned char *data;
+  size_t len;
+  bool minotaurX;
+};
+
+class CPoWCheck {
+private:
+  const CBlockHeader *header;
+  const CMinotaurVerifyInput *input;
+  const arith_uint256 *target;
+  char *result;
+  size_t count;
+
+public:
+  CPoWCheck()
+      : header(nullptr), input(nullptr), target(nullptr), result(nullptr),
+        count(0) {}
+  CPoWCheck(const CBlockHeader &headerIn, const arith_uint256 &targetIn,
+            char &resultIn, size_t countIn = 1)
+      : header(&headerIn), input(nullptr), target(&targetIn),
+        result(&resultIn), count(countIn) {}
+  CPoWCheck(const CMinotaurVerifyInput &inputIn,
+            const arith_uint256 &targetIn, char &resultIn)
+      : header(nullptr), input(&inputIn), target(&targetIn),
+        result(&resultIn), count(1) {}
+
+  bool operator()();
+
+  void swap(CPoWCheck &check) {
+    std::swap(header, check.header);
+    std::swap(input, check.input);
+    std::swap(target, check.target);
+    std::swap(result, check.result);
+    std::swap(count, check.count);
+  }
+};
+
+// Checks each input's Minotaur hash against its target on the PoW check
+// queue and returns one result per input.
+std::vector<bool>
+MinotaurBatchVerify(const std::vector<CMinotaurVerifyInput> &inputs,
+                    const std::vector<arith_uint256> &targets);
+
+std::vector<bool> HeadersBatchVerify(const std::vector<CBlockHeader> &headers,
+                                     const Consensus::Params &params);
+
 bool CheckBlock(const CBlock &block, CValidationState &state,
                 const Consensus::Params &consensusParams, bool fCheckPOW = true,
                 bool fCheckMerkleRoot = true);
@@ -257,6 +309,8 @@ bool GetTxByHashAndHeight(const uint256 txHash, const int nHeight,
                           CTransactionRef &txNew, CBlockIndex &foundAtOut,
                           CBlockIndex *pindex,
                           const Consensus::Params &consensusParams);
+bool GetIndexedBCT(const uint256 &txHash, const CBlockIndex *pindex,
+                   CDiskBCTInfo &info);
 
 bool IsHive11Enabled(const CBlockIndex *pindexPrev,
                      const Consensus::Params &params);
@@ -282,6 +336,9 @@ bool RialtoGetLocalPrivKeyForNick(const std::string nick,
 bool RialtoNickExists(const std::string nick);
 bool RialtoNickIsBlocked(const std::string nick);
 bool RialtoNickIsLocal(const std::string nick);
+bool RialtoRebuildWhitePages(int nStartHeight,
+                             const Consensus::Params &consensusParams,
+                             std::string &err);
 bool RialtoUnblockNick(const std::string nick);
 
 bool TestBlockValidity(CValidationState &state, const CChainParams &chainparams,
@@ -296,6 +353,8 @@ GenerateCoinbaseCommitment(CBlock &block, const CBlockIndex *pindexPrev,
                            const Consensus::Params &consensusParams);
 
 void InitScriptExecutionCache();
+void RialtoConnectBlockNicks(const CBlock &block, const CBlockIndex *pindex,
+                             const Consensus::Params &consensusParams);
 void UpdateUncommittedBlockStructures(CBlock &block,
                                       const CBlockIndex *pindexPrev,
                                       const Consensus::Params &consensusParams);
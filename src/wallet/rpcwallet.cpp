@@ -872,7 +872,7 @@ UniValue rialtorebuildwhitepages(const JSONRPCRequest &request) {
 
   if (request.fHelp || request.params.size() != 0) {
     throw std::runtime_error("rialtorebuildwhitepages\n"
-                             "\nReplay the local blockchain from the first "
+                             "\nRescan the local blockchain from the first "
                              "Rialto block, to catch missing registrations.\n"
                              "\nShould only be required if you have upgraded "
                              "from 0.16.3 after Rialto activation.\n"
@@ -893,40 +893,10 @@ UniValue rialtorebuildwhitepages(const JSONRPCRequest &request) {
 
   int activationHeight = VersionBitsTipStateSinceHeight(
       consensusParams, Consensus::DEPLOYMENT_RIALTO);
-  CBlockIndex *pblockindex = chainActive[activationHeight];
-  uint256 hash = pblockindex->GetBlockHash();
 
-  CValidationState state;
-
-  {
-    LOCK(cs_main);
-    if (mapBlockIndex.count(hash) == 0)
-      throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
-
-    CBlockIndex *pblockindex = mapBlockIndex[hash];
-    InvalidateBlock(state, Params(), pblockindex);
-  }
-
-  if (state.IsValid())
-    ActivateBestChain(state, Params());
-
-  if (!state.IsValid())
-    throw JSONRPCError(RPC_DATABASE_ERROR, state.GetRejectReason());
-
-  {
-    LOCK(cs_main);
-    if (mapBlockIndex.count(hash) == 0)
-      throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
-
-    CBlockIndex *pblockindex = mapBlockIndex[hash];
-    ResetBlockFailureFlags(pblockindex);
-  }
-
-  CValidationState newState;
-  ActivateBestChain(newState, Params());
-
-  if (!newState.IsValid())
-    throw JSONRPCError(RPC_DATABASE_ERROR, newState.GetRejectReason());
+  std::string err;
+  if (!RialtoRebuildWhitePages(activationHeight, consensusParams, err))
+    throw JSONRPCError(RPC_DATABASE_ERROR, "Error: " + err);
 
   return "ok";
 }
@@ -1115,29 +1085,7 @@ UniValue rialtogetincomingmessages(const JSONRPCRequest &request) {
   return jsonResults;
 }
 
-UniValue rialtoencrypt(const JSONRPCRequest &request) {
-  CWallet *const pwallet = GetWalletForJSONRPCRequest(request);
-
-  if (!EnsureWalletIsAvailable(pwallet, request.fHelp))
-    return NullUniValue;
-
-  if (request.fHelp || request.params.size() != 3)
-    throw std::runtime_error(
-        "rialtoencrypt \"from_nick\" \"to_nick\" \"message\"\n"
-        "\nEncrypt and transmit a message to a given recipient.\n"
-        "\nNote: You must have first registered your own nick.\n" +
-        HelpRequiringPassphrase(pwallet) +
-        "\nArguments:\n"
-        "1. \"from_nick\"            (string, required) Your nickname.\n"
-        "2. \"to_nick\"              (string, required) Recipient nickname.\n"
-        "3. \"message\"              (string, required) The message to "
-        "encrypt.\n"
-        "\nResult:\n"
-        "\"timestamp\"               (numeric) Sent timestamp as encoded in "
-        "Rialto envelopes.\n"
-        "\nExamples:\n" +
-        HelpExampleCli("rialtoencrypt", "\"b0ssman\" \"very secret message\""));
-
+static void EnsureRialtoCanSend(CWallet *const pwallet) {
   if (!g_connman)
     throw JSONRPCError(RPC_CLIENT_P2P_DISABLED,
                        "Error: Peer-to-peer functionality missing or disabled");
@@ -1173,6 +1121,32 @@ UniValue rialtoencrypt(const JSONRPCRequest &request) {
     throw JSONRPCError(
         RPC_RIALTO_ERROR,
         "Error: Can't encrypt messages with locked wallet; unlock it first.");
+}
+
+UniValue rialtoencrypt(const JSONRPCRequest &request) {
+  CWallet *const pwallet = GetWalletForJSONRPCRequest(request);
+
+  if (!EnsureWalletIsAvailable(pwallet, request.fHelp))
+    return NullUniValue;
+
+  if (request.fHelp || request.params.size() != 3)
+    throw std::runtime_error(
+        "rialtoencrypt \"from_nick\" \"to_nick\" \"message\"\n"
+        "\nEncrypt and transmit a message to a given recipient.\n"
+        "\nNote: You must have first registered your own nick.\n" +
+        HelpRequiringPassphrase(pwallet) +
+        "\nArguments:\n"
+        "1. \"from_nick\"            (string, required) Your nickname.\n"
+        "2. \"to_nick\"              (string, required) Recipient nickname.\n"
+        "3. \"message\"              (string, required) The message to "
+        "encrypt.\n"
+        "\nResult:\n"
+        "\"timestamp\"               (numeric) Sent timestamp as encoded in "
+        "Rialto envelopes.\n"
+        "\nExamples:\n" +
+        HelpExampleCli("rialtoencrypt", "\"b0ssman\" \"very secret message\""));
+
+  EnsureRialtoCanSend(pwallet);
 
   RPCTypeCheckArgument(request.params[0], UniValue::VSTR);
   const std::string nickFrom = request.params[0].get_str();
@@ -1207,6 +1181,108 @@ UniValue rialtoencrypt(const JSONRPCRequest &request) {
   return (int64_t)timestamp;
 }
 
+UniValue rialtoencryptbatch(const JSONRPCRequest &request) {
+  CWallet *const pwallet = GetWalletForJSONRPCRequest(request);
+
+  if (!EnsureWalletIsAvailable(pwallet, request.fHelp))
+    return NullUniValue;
+
+  if (request.fHelp || request.params.size() != 1)
+    throw std::runtime_error(
+        "rialtoencryptbatch [{\"from_nick\":\"nick\",\"to_nick\":\"nick\","
+        "\"message\":\"text\"},...]\n"
+        "\nEncrypt and transmit several messages, finding their proof of work "
+        "concurrently on -rialtopowthreads threads. At most " +
+        std::to_string(MAX_RIALTO_ENCRYPT_BATCH) +
+        " messages can be sent at once.\n"
+        "\nNote: You must have first registered your own nicks.\n" +
+        HelpRequiringPassphrase(pwallet) +
+        "\nArguments:\n"
+        "1. \"messages\"             (array, required) The messages to send\n"
+        "   [\n"
+        "     {\n"
+        "       \"from_nick\":\"nick\",  (string, required) Your nickname\n"
+        "       \"to_nick\":\"nick\",    (string, required) Recipient "
+        "nickname\n"
+        "       \"message\":\"text\"     (string, required) The message to "
+        "encrypt\n"
+        "     }\n"
+        "     ,...\n"
+        "   ]\n"
+        "\nResult:\n"
+        "[                           (array) One entry per message, in order\n"
+        "  {\n"
+        "    \"timestamp\": n,         (numeric) Sent timestamp, if sent\n"
+        "    \"error\": \"text\"       (string) Why the message wasn't sent, "
+        "if not\n"
+        "  }\n"
+        "  ,...\n"
+        "]\n"
+        "\nExamples:\n" +
+        HelpExampleRpc("rialtoencryptbatch",
+                       "[{\"from_nick\":\"b0ssman\",\"to_nick\":\"alice\","
+                       "\"message\":\"hi\"}]"));
+
+  EnsureRialtoCanSend(pwallet);
+
+  RPCTypeCheckArgument(request.params[0], UniValue::VARR);
+  const UniValue &entries = request.params[0].get_array();
+  if (entries.empty())
+    throw JSONRPCError(RPC_RIALTO_ERROR, "Error: No messages provided.");
+  if (entries.size() > MAX_RIALTO_ENCRYPT_BATCH)
+    throw JSONRPCError(RPC_RIALTO_ERROR,
+                       strprintf("Error: At most %u messages can be sent at "
+                                 "once.",
+                                 MAX_RIALTO_ENCRYPT_BATCH));
+
+  std::vector<std::string> errors(entries.size());
+  std::vector<size_t> positions;
+  std::vector<RialtoOutgoingMessage> messages;
+  for (size_t i = 0; i < entries.size(); i++) {
+    const UniValue &entry = entries[i].get_obj();
+    RPCTypeCheckObj(entry, {
+                               {"from_nick", UniValueType(UniValue::VSTR)},
+                               {"to_nick", UniValueType(UniValue::VSTR)},
+                               {"message", UniValueType(UniValue::VSTR)},
+                           });
+    RialtoOutgoingMessage msg;
+    msg.nickFrom = find_value(entry, "from_nick").get_str();
+    msg.nickTo = find_value(entry, "to_nick").get_str();
+    msg.plaintext = find_value(entry, "message").get_str();
+    if (msg.nickTo == "" || !RialtoNickExists(msg.nickTo)) {
+      errors[i] = "Recipient's nickname is not registered.";
+      continue;
+    }
+    positions.push_back(i);
+    messages.push_back(msg);
+  }
+
+  RialtoEncryptMessages(messages);
+
+  std::vector<int64_t> timestamps(entries.size(), -1);
+  for (size_t i = 0; i < messages.size(); i++) {
+    if (!messages[i].fSuccess) {
+      errors[positions[i]] = "Couldn't encrypt: " + messages[i].err;
+      continue;
+    }
+    CRialtoMessage msg(messages[i].ciphertext);
+    RelayRialtoMessage(msg, g_connman.get());
+    timestamps[positions[i]] = messages[i].timestampSent;
+  }
+
+  UniValue results(UniValue::VARR);
+  for (size_t i = 0; i < entries.size(); i++) {
+    UniValue result(UniValue::VOBJ);
+    if (timestamps[i] >= 0)
+      result.push_back(Pair("timestamp", timestamps[i]));
+    else
+      result.push_back(Pair("error", errors[i]));
+    results.push_back(result);
+  }
+
+  return results;
+}
+
 UniValue getnetworkhiveinfo(const JSONRPCRequest &request) {
   if (request.fHelp || request.params.size() > 1)
     throw std::runtime_error(
@@ -5152,6 +5228,8 @@ static const CRPCCommand commands[] = {
      &rialtoencrypt,
      {"sender_nick", "destination_nick", "message"}},
 
+    {"wallet", "rialtoencryptbatch", &rialtoencryptbatch, {"messages"}},
+
     {"wallet", "rialtoblocknick", &rialtoblocknick, {"nickname"}},
 
     {"wallet", "rialtounblocknick", &rialtounblocknick, {"nickname"}},
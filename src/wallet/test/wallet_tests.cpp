@@ -4,11 +4,14 @@
 
 #include <wallet/wallet.h>
 
+#include <algorithm>
 #include <set>
 #include <stdint.h>
 #include <utility>
 #include <vector>
 
+#include <base58.h>
+#include <chainparams.h>
 #include <consensus/validation.h>
 #include <rpc/server.h>
 #include <test/test_bitcoin.h>
@@ -649,4 +652,206 @@ BOOST_FIXTURE_TEST_CASE(ListCoins, ListCoinsTestingSetup) {
   BOOST_CHECK_EQUAL(list.begin()->second.size(), 2);
 }
 
+static CBlockIndex *AddBlockIndex(CBlockIndex *pprev) {
+  auto inserted = mapBlockIndex.emplace(GetRandHash(), new CBlockIndex);
+  assert(inserted.second);
+  CBlockIndex *pindex = inserted.first->second;
+  pindex->phashBlock = &inserted.first->first;
+  pindex->pprev = pprev;
+  pindex->nHeight = pprev ? pprev->nHeight + 1 : 0;
+  pindex->BuildSkip();
+  return pindex;
+}
+
+static CWalletTx AddBCT(CWallet &wallet, const COutPoint &prevout,
+                        const CBlockIndex *pindex, int beeCount,
+                        bool communityContrib, const CScript &scriptPubKeyHoney,
+                        const Consensus::Params &params) {
+  CScript scriptPubKeyBCF =
+      GetScriptForDestination(DecodeDestination(params.beeCreationAddress));
+  scriptPubKeyBCF << OP_RETURN << OP_BEE;
+  scriptPubKeyBCF += scriptPubKeyHoney;
+  CAmount beeCost = GetBeeCost(pindex->nHeight, params);
+
+  CMutableTransaction tx;
+  tx.vin.push_back(CTxIn(prevout));
+  if (communityContrib) {
+    tx.vout.push_back(CTxOut(beeCount * beeCost / 2, scriptPubKeyBCF));
+    tx.vout.push_back(CTxOut(
+        beeCount * beeCost - beeCount * beeCost / 2,
+        GetScriptForDestination(
+            DecodeDestination(params.hiveCommunityAddress))));
+  } else {
+    tx.vout.push_back(CTxOut(beeCount * beeCost, scriptPubKeyBCF));
+  }
+
+  CWalletTx wtx(&wallet, MakeTransactionRef(tx));
+  wtx.SetMerkleBranch(pindex, 0);
+  wallet.AddToWallet(wtx);
+  return wtx;
+}
+
+static std::vector<std::string> MatureBees(CWallet &wallet,
+                                           const CBlockIndex *pindexTip,
+                                           const Consensus::Params &params) {
+  std::vector<std::string> bees;
+  for (const CBeeRange &range : wallet.GetMatureBeeRanges(pindexTip, params))
+    bees.push_back(range.txid + ":" + range.honeyAddress + ":" +
+                   std::to_string(range.communityContrib) + ":" +
+                   std::to_string(range.offset) + ":" +
+                   std::to_string(range.count));
+  std::sort(bees.begin(), bees.end());
+  return bees;
+}
+
+static std::vector<std::string>
+MatureBCTs(CWallet &wallet, CBlockIndex *pindexTip,
+           const Consensus::Params &params) {
+  chainActive.SetTip(pindexTip);
+  std::vector<std::string> bees;
+  for (const CBeeCreationTransactionInfo &bct :
+       wallet.GetBCTs(false, false, params))
+    if (bct.beeStatus == "mature")
+      bees.push_back(bct.txid + ":" + bct.honeyAddress + ":" +
+                     std::to_string(bct.communityContrib) + ":0:" +
+                     std::to_string(bct.beeCount));
+  std::sort(bees.begin(), bees.end());
+  return bees;
+}
+
+BOOST_AUTO_TEST_CASE(mature_bee_snapshot) {
+  Consensus::Params params = Params().GetConsensus();
+  params.beeGestationBlocks = 5;
+  params.beeLifespanBlocks = 10;
+
+  CWallet wallet;
+  CKey key;
+  key.MakeNewKey(true);
+  wallet.AddKeyPubKey(key, key.GetPubKey());
+  CScript scriptPubKey = GetScriptForRawPubKey(key.GetPubKey());
+  CScript scriptPubKeyHoney =
+      GetScriptForDestination(key.GetPubKey().GetID());
+
+  CMutableTransaction funding;
+  funding.vin.push_back(CTxIn(COutPoint(GetRandHash(), 0)));
+  for (int i = 0; i < 6; i++)
+    funding.vout.push_back(CTxOut(1000 * COIN, scriptPubKey));
+  wallet.AddToWallet(CWalletTx(&wallet, MakeTransactionRef(funding)));
+  uint256 fundingHash = funding.GetHash();
+
+  LOCK2(cs_main, wallet.cs_wallet);
+  CBlockIndex *pindexOldTip = chainActive.Tip();
+
+  std::vector<CBlockIndex *> chain(1, AddBlockIndex(nullptr));
+  while (chain.size() < 40)
+    chain.push_back(AddBlockIndex(chain.back()));
+  std::vector<CBlockIndex *> fork(1, chain[20]);
+  while (fork.size() < 16)
+    fork.push_back(AddBlockIndex(fork.back()));
+
+  AddBCT(wallet, COutPoint(fundingHash, 0), chain[3], 10, false,
+         scriptPubKeyHoney, params);
+  AddBCT(wallet, COutPoint(fundingHash, 1), chain[3], 3, false,
+         scriptPubKeyHoney, params);
+  AddBCT(wallet, COutPoint(fundingHash, 2), chain[7], 4, false,
+         scriptPubKeyHoney, params);
+
+  for (int i = 1; i < 40; i++) {
+    if (i == 10) {
+      AddBCT(wallet, COutPoint(fundingHash, 3), chain[12], 7, true,
+             scriptPubKeyHoney, params);
+      AddBCT(wallet, COutPoint(fundingHash, 4), fork[1], 5, false,
+             scriptPubKeyHoney, params);
+    }
+    BOOST_CHECK(MatureBees(wallet, chain[i], params) ==
+                MatureBCTs(wallet, chain[i], params));
+  }
+  BOOST_CHECK_EQUAL(MatureBees(wallet, chain[8], params).size(), 2U);
+  BOOST_CHECK_EQUAL(MatureBees(wallet, chain[12], params).size(), 3U);
+  BOOST_CHECK_EQUAL(MatureBees(wallet, chain[18], params).size(), 2U);
+  BOOST_CHECK_EQUAL(MatureBees(wallet, chain[25], params).size(), 1U);
+  BOOST_CHECK(MatureBees(wallet, chain[30], params).empty());
+
+  for (size_t i = 1; i < fork.size(); i++)
+    BOOST_CHECK(MatureBees(wallet, fork[i], params) ==
+                MatureBCTs(wallet, fork[i], params));
+  BOOST_CHECK_EQUAL(MatureBees(wallet, fork[6], params).size(), 2U);
+
+  CWalletTx wtx = AddBCT(wallet, COutPoint(fundingHash, 5), fork[3], 5,
+                         false, scriptPubKeyHoney, params);
+  BOOST_CHECK_EQUAL(MatureBees(wallet, fork[8], params).size(), 2U);
+  wtx.SetMerkleBranch(chain[24], 0);
+  wallet.AddToWallet(wtx);
+  BOOST_CHECK_EQUAL(MatureBees(wallet, fork[8], params).size(), 1U);
+  for (int i = 20; i < 40; i++)
+    BOOST_CHECK(MatureBees(wallet, chain[i], params) ==
+                MatureBCTs(wallet, chain[i], params));
+  BOOST_CHECK_EQUAL(MatureBees(wallet, chain[29], params).size(), 1U);
+  BOOST_CHECK_EQUAL(MatureBees(wallet, chain[30], params).size(), 1U);
+
+  chainActive.SetTip(pindexOldTip);
+}
+
+BOOST_AUTO_TEST_CASE(mature_bee_snapshot_cost_boundary) {
+  Consensus::Params params = Params().GetConsensus();
+  params.beeGestationBlocks = 5;
+  params.beeLifespanBlocks = 10;
+  params.totalMoneySupplyHeight = 10;
+  BOOST_REQUIRE(GetBeeCost(9, params) > GetBeeCost(10, params));
+
+  CWallet wallet;
+  CKey key;
+  key.MakeNewKey(true);
+  wallet.AddKeyPubKey(key, key.GetPubKey());
+  CScript scriptPubKey = GetScriptForRawPubKey(key.GetPubKey());
+  CScript scriptPubKeyHoney =
+      GetScriptForDestination(key.GetPubKey().GetID());
+
+  CMutableTransaction funding;
+  funding.vin.push_back(CTxIn(COutPoint(GetRandHash(), 0)));
+  for (int i = 0; i < 2; i++)
+    funding.vout.push_back(CTxOut(1000 * COIN, scriptPubKey));
+  wallet.AddToWallet(CWalletTx(&wallet, MakeTransactionRef(funding)));
+  uint256 fundingHash = funding.GetHash();
+
+  LOCK2(cs_main, wallet.cs_wallet);
+  CBlockIndex *pindexOldTip = chainActive.Tip();
+
+  std::vector<CBlockIndex *> chain(1, AddBlockIndex(nullptr));
+  while (chain.size() < 30)
+    chain.push_back(AddBlockIndex(chain.back()));
+
+  // Bees are priced at the height of the block holding the BCT, as in
+  // CheckHiveProof, so a BCT mined right at the boundary buys bees at the
+  // lower cost.
+  CWalletTx wtx = AddBCT(wallet, COutPoint(fundingHash, 0), chain[9], 2, false,
+                         scriptPubKeyHoney, params);
+  AddBCT(wallet, COutPoint(fundingHash, 1), chain[10], 3, false,
+         scriptPubKeyHoney, params);
+
+  for (int i = 1; i < 30; i++)
+    BOOST_CHECK(MatureBees(wallet, chain[i], params) ==
+                MatureBCTs(wallet, chain[i], params));
+
+  std::vector<CBeeRange> ranges = wallet.GetMatureBeeRanges(chain[15], params);
+  BOOST_REQUIRE_EQUAL(ranges.size(), 2U);
+  int bees = 0;
+  for (const CBeeRange &range : ranges)
+    bees += range.count;
+  BOOST_CHECK_EQUAL(bees, 5);
+
+  wtx.SetMerkleBranch(chain[10], 0);
+  wallet.AddToWallet(wtx);
+  ranges = wallet.GetMatureBeeRanges(chain[15], params);
+  bees = 0;
+  for (const CBeeRange &range : ranges)
+    bees += range.count;
+  BOOST_CHECK_EQUAL(bees, 2 * GetBeeCost(9, params) / GetBeeCost(10, params) +
+                              3);
+  BOOST_CHECK(MatureBees(wallet, chain[15], params) ==
+              MatureBCTs(wallet, chain[15], params));
+
+  chainActive.SetTip(pindexOldTip);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -575,6 +575,19 @@ void CWallet::AddToSpends(const uint256 &wtxid) {
     AddToSpends(txin.prevout, wtxid);
 }
 
+void CWallet::AddToHoneyRewards(const uint256 &wtxid) {
+  auto it = mapWallet.find(wtxid);
+  assert(it != mapWallet.end());
+  const CWalletTx &thisTx = it->second;
+  if (!thisTx.IsHiveCoinBase() || thisTx.tx->vout.size() < 2 ||
+      thisTx.tx->vout[0].scriptPubKey.size() < 14 + 64)
+    return;
+
+  std::string bctTxid(&thisTx.tx->vout[0].scriptPubKey[14],
+                      &thisTx.tx->vout[0].scriptPubKey[14 + 64]);
+  mapHoneyRewards.insert(std::make_pair(bctTxid, wtxid));
+}
+
 bool CWallet::EncryptWallet(const SecureString &strWalletPassphrase) {
   if (IsCrypted())
     return false;
@@ -863,6 +876,7 @@ bool CWallet::AddToWallet(const CWalletTx &wtxIn, bool fFlushOnClose) {
     wtxOrdered.insert(std::make_pair(wtx.nOrderPos, TxPair(&wtx, nullptr)));
     wtx.nTimeSmart = ComputeTimeSmart(wtx);
     AddToSpends(hash);
+    AddToHoneyRewards(hash);
   }
 
   bool fUpdated = false;
@@ -891,6 +905,9 @@ bool CWallet::AddToWallet(const CWalletTx &wtxIn, bool fFlushOnClose) {
     }
   }
 
+  if (fInsertedNew || fUpdated)
+    IndexBCT(wtx, Params().GetConsensus());
+
   LogPrintf("AddToWallet %s  %s%s\n", wtxIn.GetHash().ToString(),
             (fInsertedNew ? "new" : ""), (fUpdated ? "update" : ""));
 
@@ -918,6 +935,7 @@ bool CWallet::LoadToWallet(const CWalletTx &wtxIn) {
   wtx.BindWallet(this);
   wtxOrdered.insert(std::make_pair(wtx.nOrderPos, TxPair(&wtx, nullptr)));
   AddToSpends(hash);
+  AddToHoneyRewards(hash);
   for (const CTxIn &txin : wtx.tx->vin) {
     auto it = mapWallet.find(txin.prevout.hash);
     if (it != mapWallet.end()) {
@@ -1158,6 +1176,7 @@ void CWallet::BlockConnected(
   }
 
   m_last_block_processed = pindex;
+  UpdateBeeSnapshot(pindex, Params().GetConsensus());
 }
 
 void CWallet::BlockDisconnected(const std::shared_ptr<const CBlock> &pblock) {
@@ -2472,7 +2491,7 @@ CWallet::GetBCT(const CWalletTx &wtx, bool includeDead, bool scanRewards,
     }
   }
 
-  int height = chainActive.Height() - depth;
+  int height = chainActive.Height() - depth + 1;
   CAmount beeCost = GetBeeCost(height, consensusParams);
   bool communityContrib = false;
   if (wtx.tx->vout.size() > 1 &&
@@ -2487,24 +2506,19 @@ CWallet::GetBCT(const CWalletTx &wtx, bool includeDead, bool scanRewards,
   int blocksFound = 0;
   CAmount rewardsPaid = 0;
   if (isMature && scanRewards) {
-    for (const std::pair<uint256, CWalletTx> &pairWtx2 : mapWallet) {
-      const CWalletTx &wtx2 = pairWtx2.second;
-
-      if (!wtx2.IsHiveCoinBase())
+    std::pair<HoneyRewards::const_iterator, HoneyRewards::const_iterator>
+        range = mapHoneyRewards.equal_range(bctTxid);
+    for (HoneyRewards::const_iterator it = range.first; it != range.second;
+         ++it) {
+      std::map<uint256, CWalletTx>::const_iterator mi =
+          mapWallet.find(it->second);
+      if (mi == mapWallet.end())
         continue;
+      const CWalletTx &wtx2 = mi->second;
 
       if (wtx2.GetDepthInMainChain() < minHoneyConfirmations)
         continue;
 
-      std::vector<unsigned char> blockTxid(
-          &wtx2.tx->vout[0].scriptPubKey[14],
-          &wtx2.tx->vout[0].scriptPubKey[14 + 64]);
-      std::string blockTxidStr =
-          std::string(blockTxid.begin(), blockTxid.end());
-
-      if (bctTxid != blockTxidStr)
-        continue;
-
       blocksFound++;
       rewardsPaid += wtx2.tx->vout[1].nValue;
     }
@@ -2565,6 +2579,164 @@ CWallet::GetBCTs(bool includeDead, bool scanRewards,
   return bcts;
 }
 
+void CWallet::IndexBCT(const CWalletTx &wtx,
+                       const Consensus::Params &consensusParams) {
+  AssertLockHeld(cs_wallet);
+
+  if (!fBCTsIndexed)
+    return;
+
+  uint256 hash = wtx.GetHash();
+  std::map<uint256, CWalletBCT>::iterator it = mapWalletBCTs.find(hash);
+  if (it != mapWalletBCTs.end()) {
+    std::pair<std::multimap<uint256, uint256>::iterator,
+              std::multimap<uint256, uint256>::iterator>
+        range = mapBCTsByBlock.equal_range(it->second.hashBlock);
+    for (std::multimap<uint256, uint256>::iterator mi = range.first;
+         mi != range.second; ++mi) {
+      if (mi->second == hash) {
+        mapBCTsByBlock.erase(mi);
+        break;
+      }
+    }
+    mapWalletBCTs.erase(it);
+    pindexBeeSnapshot = nullptr;
+  }
+
+  if (wtx.hashUnset() || wtx.nIndex == -1 || wtx.IsCoinBase())
+    return;
+
+  CScript scriptPubKeyBCF = GetScriptForDestination(
+      DecodeDestination(consensusParams.beeCreationAddress));
+  CAmount beeFeePaid;
+  CScript scriptPubKeyHoney;
+  if (!wtx.tx->IsBCT(consensusParams, scriptPubKeyBCF, &beeFeePaid,
+                     &scriptPubKeyHoney))
+    return;
+
+  // Unlike GetBCT, ownership of the inputs is only checked when the
+  // transaction is indexed. A BCT whose inputs only become spendable later,
+  // e.g. after importing a key, is not mined with until the wallet reloads.
+  if (!IsAllFromMe(*wtx.tx, ISMINE_SPENDABLE))
+    return;
+
+  CTxDestination honeyDestination;
+  if (!ExtractDestination(scriptPubKeyHoney, honeyDestination))
+    return;
+
+  CScript scriptPubKeyCF = GetScriptForDestination(
+      DecodeDestination(consensusParams.hiveCommunityAddress));
+  CWalletBCT bct;
+  bct.honeyAddress = EncodeDestination(honeyDestination);
+  bct.communityContrib = false;
+  if (wtx.tx->vout.size() > 1 &&
+      wtx.tx->vout[1].scriptPubKey == scriptPubKeyCF) {
+    beeFeePaid += wtx.tx->vout[1].nValue;
+    bct.communityContrib = true;
+  }
+  bct.beeFeePaid = beeFeePaid;
+  bct.hashBlock = wtx.hashBlock;
+
+  mapWalletBCTs[hash] = bct;
+  mapBCTsByBlock.insert(std::make_pair(wtx.hashBlock, hash));
+  pindexBeeSnapshot = nullptr;
+}
+
+void CWallet::IndexBCTs(const Consensus::Params &consensusParams) {
+  AssertLockHeld(cs_wallet);
+
+  mapWalletBCTs.clear();
+  mapBCTsByBlock.clear();
+  fBCTsIndexed = true;
+  for (const std::pair<uint256, CWalletTx> &pairWtx : mapWallet)
+    IndexBCT(pairWtx.second, consensusParams);
+  pindexBeeSnapshot = nullptr;
+}
+
+void CWallet::AddToBeeSnapshot(const uint256 &hash, const CWalletBCT &bct,
+                               int nHeight,
+                               const Consensus::Params &consensusParams) {
+  int beeCount = bct.beeFeePaid / GetBeeCost(nHeight, consensusParams);
+  if (beeCount < 1)
+    return;
+
+  CBeeRange range = {hash.GetHex(), bct.honeyAddress, bct.communityContrib, 0,
+                     beeCount};
+  mapBeeSnapshot.insert(std::make_pair(nHeight, range));
+}
+
+void CWallet::UpdateBeeSnapshot(const CBlockIndex *pindexTip,
+                                const Consensus::Params &consensusParams) {
+  AssertLockHeld(cs_main);
+  AssertLockHeld(cs_wallet);
+
+  if (!fBCTsIndexed)
+    IndexBCTs(consensusParams);
+
+  if (pindexTip == nullptr) {
+    mapBeeSnapshot.clear();
+    pindexBeeSnapshot = nullptr;
+    return;
+  }
+
+  if (pindexTip == pindexBeeSnapshot)
+    return;
+
+  int nMatureHeight = pindexTip->nHeight - consensusParams.beeGestationBlocks;
+  int nExpiredHeight = nMatureHeight - consensusParams.beeLifespanBlocks;
+
+  if (pindexBeeSnapshot && pindexTip->pprev == pindexBeeSnapshot) {
+    mapBeeSnapshot.erase(mapBeeSnapshot.begin(),
+                         mapBeeSnapshot.upper_bound(nExpiredHeight));
+
+    const CBlockIndex *pindexMature = pindexTip->GetAncestor(nMatureHeight);
+    if (pindexMature) {
+      std::pair<std::multimap<uint256, uint256>::const_iterator,
+                std::multimap<uint256, uint256>::const_iterator>
+          range = mapBCTsByBlock.equal_range(pindexMature->GetBlockHash());
+      for (std::multimap<uint256, uint256>::const_iterator mi = range.first;
+           mi != range.second; ++mi)
+        AddToBeeSnapshot(mi->second, mapWalletBCTs[mi->second], nMatureHeight,
+                         consensusParams);
+    }
+  } else {
+    mapBeeSnapshot.clear();
+    for (const auto &pairBCT : mapWalletBCTs) {
+      BlockMap::const_iterator mi =
+          mapBlockIndex.find(pairBCT.second.hashBlock);
+      if (mi == mapBlockIndex.end())
+        continue;
+
+      const CBlockIndex *pindex = mi->second;
+      if (pindex->nHeight <= nExpiredHeight || pindex->nHeight > nMatureHeight)
+        continue;
+
+      if (pindexTip->GetAncestor(pindex->nHeight) != pindex)
+        continue;
+
+      AddToBeeSnapshot(pairBCT.first, pairBCT.second, pindex->nHeight,
+                       consensusParams);
+    }
+  }
+
+  pindexBeeSnapshot = pindexTip;
+}
+
+std::vector<CBeeRange>
+CWallet::GetMatureBeeRanges(const CBlockIndex *pindexTip,
+                            const Consensus::Params &consensusParams) {
+  LOCK2(cs_main, cs_wallet);
+
+  UpdateBeeSnapshot(pindexTip, consensusParams);
+
+  std::vector<CBeeRange> ranges;
+  ranges.reserve(mapBeeSnapshot.size());
+  for (const auto &pairRange : mapBeeSnapshot)
+    ranges.push_back(pairRange.second);
+
+  return ranges;
+}
+
 bool CWallet::CreateBeeTransaction(
     int beeCount, CWalletTx &wtxNew, CReserveKey &reservekeyChange,
     CReserveKey &reservekeyHoney, std::string honeyAddress,
@@ -4149,6 +4321,9 @@ CWallet *CWallet::CreateWalletFromFile(const std::string walletFile) {
   walletInstance->SetBroadcastTransactions(
       gArgs.GetBoolArg("-walletbroadcast", DEFAULT_WALLETBROADCAST));
 
+  walletInstance->NotifyStatusChanged.connect(
+      [](CCryptoKeyStore *) { RialtoInvalidateLocalKeyCache(); });
+
   {
     LOCK(walletInstance->cs_wallet);
     LogPrintf("setKeyPool.size() = %u\n", walletInstance->GetKeyPoolSize());
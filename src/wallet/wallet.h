@@ -587,6 +587,13 @@ struct CBeeRange {
   int count;
 };
 
+struct CWalletBCT {
+  std::string honeyAddress;
+  bool communityContrib;
+  CAmount beeFeePaid;
+  uint256 hashBlock;
+};
+
 class WalletRescanReserver;
 
 class CWallet final : public CCryptoKeyStore, public CValidationInterface {
@@ -618,6 +625,23 @@ private:
   void AddToSpends(const COutPoint &outpoint, const uint256 &wtxid);
   void AddToSpends(const uint256 &wtxid);
 
+  typedef std::multimap<std::string, uint256> HoneyRewards;
+  HoneyRewards mapHoneyRewards;
+  void AddToHoneyRewards(const uint256 &wtxid);
+
+  bool fBCTsIndexed;
+  std::map<uint256, CWalletBCT> mapWalletBCTs;
+  std::multimap<uint256, uint256> mapBCTsByBlock;
+  const CBlockIndex *pindexBeeSnapshot;
+  std::multimap<int, CBeeRange> mapBeeSnapshot;
+  void IndexBCT(const CWalletTx &wtx,
+                const Consensus::Params &consensusParams);
+  void IndexBCTs(const Consensus::Params &consensusParams);
+  void AddToBeeSnapshot(const uint256 &hash, const CWalletBCT &bct,
+                        int nHeight, const Consensus::Params &consensusParams);
+  void UpdateBeeSnapshot(const CBlockIndex *pindexTip,
+                         const Consensus::Params &consensusParams);
+
   void MarkConflicted(const uint256 &hashBlock, const uint256 &hashTx);
 
   void SyncMetaData(std::pair<TxSpends::iterator, TxSpends::iterator>);
@@ -693,6 +717,8 @@ public:
     nRelockTime = 0;
     fAbortRescan = false;
     fScanningWallet = false;
+    fBCTsIndexed = false;
+    pindexBeeSnapshot = nullptr;
   }
 
   std::map<uint256, CWalletTx> mapWallet;
@@ -869,6 +895,10 @@ public:
           const Consensus::Params &consensusParams,
           int minHoneyConfirmations = 1);
 
+  std::vector<CBeeRange>
+  GetMatureBeeRanges(const CBlockIndex *pindexTip,
+                     const Consensus::Params &consensusParams);
+
   bool CreateNickRegistrationTransaction(
       std::string nickname, CWalletTx &wtxNew, CReserveKey &reservekeyChange,
       CReserveKey &reservekeyNickAddress, std::string nickAddress,